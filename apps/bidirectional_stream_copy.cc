@@ -16,8 +16,8 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
   EventLoop _eventloop {};
   FileDescriptor _input { STDIN_FILENO };
   FileDescriptor _output { STDOUT_FILENO };
-  ByteStream _outbound { buffer_size };
-  ByteStream _inbound { buffer_size };
+  ByteStream _outbound { buffer_size, ByteStream::Storage::Ring };
+  ByteStream _inbound { buffer_size, ByteStream::Storage::Ring };
   bool _outbound_shutdown { false };
   bool _inbound_shutdown { false };
 
@@ -31,10 +31,7 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     _input,
     Direction::In,
     [&] {
-      string data;
-      data.resize( _outbound.writer().available_capacity() );
-      _input.read( data );
-      _outbound.writer().push( move( data ) );
+      _outbound.writer().push_from( _input );
       if ( _input.eof() ) {
         _outbound.writer().close();
       }
@@ -57,7 +54,7 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     Direction::Out,
     [&] {
       if ( _outbound.reader().bytes_buffered() ) {
-        _outbound.reader().pop( socket.write( _outbound.reader().peek() ) );
+        _outbound.reader().pop( socket.write( _outbound.reader().peek_all() ) );
       }
       if ( _outbound.reader().is_finished() ) {
         socket.shutdown( SHUT_WR );
@@ -81,10 +78,7 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     socket,
     Direction::In,
     [&] {
-      string data;
-      data.resize( _inbound.writer().available_capacity() );
-      socket.read( data );
-      _inbound.writer().push( move( data ) );
+      _inbound.writer().push_from( socket );
       if ( socket.eof() ) {
         _inbound.writer().close();
       }
@@ -107,7 +101,7 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     Direction::Out,
     [&] {
       if ( _inbound.reader().bytes_buffered() ) {
-        _inbound.reader().pop( _output.write( _inbound.reader().peek() ) );
+        _inbound.reader().pop( _output.write( _inbound.reader().peek_all() ) );
       }
       if ( _inbound.reader().is_finished() ) {
         _output.close();
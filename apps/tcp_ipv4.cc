@@ -31,9 +31,25 @@ void show_usage( const char* argv0, const char* msg )
        << "   -s <port>       Set source port (client mode only)              (random)\n\n"
 
        << "   -w <winsz>      Use a window of <winsz> bytes                   " << TCPConfig::MAX_PAYLOAD_SIZE
-       << "\n\n"
+       << "\n"
+       << "   -W              Offer window scaling (for windows over 64 KiB). (off)\n\n"
 
-       << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n\n"
+       << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n"
+       << "   -r              Adapt the timeout to the measured RTT.          (off)\n"
+       << "   -T              Offer timestamps (RTT samples, PAWS).           (off)\n"
+       << "   -D <ms>         Delay ACKs of in-order data by up to <ms>.      (no delay; typically "
+       << TCPConfig::ACK_DELAY_DFLT << ")\n\n"
+
+       << "   -S              Offer selective acknowledgments (SACK).         (off)\n\n"
+
+       << "   -C <algo>       Congestion control: reno or cubic               (none)\n"
+       << "   -F              Fast retransmit and NewReno fast recovery.      (off)\n"
+       << "   -P <rate>       Pace at <rate> bytes/s; 0 for cwnd / SRTT (-r). (off)\n\n"
+
+       << "   -m <mss>        Largest segment payload to send or accept       " << TCPConfig::MAX_PAYLOAD_SIZE
+       << "\n"
+       << "   -G              Send super-segments, split by the adapter.      (off)\n"
+       << "   -N              Coalesce small writes (Nagle's algorithm).      (off)\n\n"
 
        << "   -d <tundev>     Connect to tun <tundev>                         " << TUN_DFLT << "\n\n"
 
@@ -91,11 +107,67 @@ tuple<TCPConfig, FdAdapterConfig, bool, const char*> get_config( const span<char
       c_fsm.recv_capacity = strtol( args[curr + 1], nullptr, 0 );
       curr += 2;
 
+    } else if ( strncmp( "-W", args[curr], 3 ) == 0 ) {
+      c_fsm.window_scaling = true;
+      curr += 1;
+
     } else if ( strncmp( "-t", args[curr], 3 ) == 0 ) {
       check_argc( args, curr, "ERROR: -t requires one argument." );
       c_fsm.rt_timeout = strtol( args[curr + 1], nullptr, 0 );
       curr += 2;
 
+    } else if ( strncmp( "-r", args[curr], 3 ) == 0 ) {
+      c_fsm.adaptive_rto = true;
+      curr += 1;
+
+    } else if ( strncmp( "-T", args[curr], 3 ) == 0 ) {
+      c_fsm.timestamps = true;
+      curr += 1;
+
+    } else if ( strncmp( "-D", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -D requires one argument." );
+      c_fsm.ack_delay_ms = static_cast<uint16_t>( strtol( args[curr + 1], nullptr, 0 ) );
+      curr += 2;
+
+    } else if ( strncmp( "-S", args[curr], 3 ) == 0 ) {
+      c_fsm.sack = true;
+      curr += 1;
+
+    } else if ( strncmp( "-C", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -C requires one argument." );
+      if ( strcmp( "reno", args[curr + 1] ) == 0 ) {
+        c_fsm.congestion = CongestionControl::Algorithm::Reno;
+      } else if ( strcmp( "cubic", args[curr + 1] ) == 0 ) {
+        c_fsm.congestion = CongestionControl::Algorithm::Cubic;
+      } else {
+        show_usage( args[0], "ERROR: -C must be reno or cubic." );
+        exit( 1 );
+      }
+      curr += 2;
+
+    } else if ( strncmp( "-F", args[curr], 3 ) == 0 ) {
+      c_fsm.fast_retransmit = true;
+      curr += 1;
+
+    } else if ( strncmp( "-P", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -P requires one argument." );
+      c_fsm.pacing = true;
+      c_fsm.pacing_rate = strtoull( args[curr + 1], nullptr, 0 );
+      curr += 2;
+
+    } else if ( strncmp( "-m", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -m requires one argument." );
+      c_fsm.mss = static_cast<uint16_t>( strtol( args[curr + 1], nullptr, 0 ) );
+      curr += 2;
+
+    } else if ( strncmp( "-G", args[curr], 3 ) == 0 ) {
+      c_fsm.super_segments = true;
+      curr += 1;
+
+    } else if ( strncmp( "-N", args[curr], 3 ) == 0 ) {
+      c_fsm.nagle = true;
+      curr += 1;
+
     } else if ( strncmp( "-d", args[curr], 3 ) == 0 ) {
       check_argc( args, curr, "ERROR: -t requires one argument." );
       tundev = args[curr + 1];
@@ -14,6 +14,15 @@ macro (ttest name)
   set_property(TEST unsanitized_${name} PROPERTY FIXTURES_REQUIRED compile)
 endmacro (ttest)
 
+# the same test, run again against Reassembler::Engine::Bitmap
+macro (rtest name)
+  ttest(${name})
+
+  add_test(NAME ${name}_bitmap COMMAND "${name}_sanitized")
+  set_property(TEST ${name}_bitmap PROPERTY FIXTURES_REQUIRED compile)
+  set_property(TEST ${name}_bitmap PROPERTY ENVIRONMENT REASSEMBLER_ENGINE=bitmap)
+endmacro (rtest)
+
 set_property(TEST ${compile_name} PROPERTY TIMEOUT 0)
 set_tests_properties(${compile_name} PROPERTIES FIXTURES_SETUP compile)
 
@@ -26,14 +35,16 @@ ttest(byte_stream_one_write)
 ttest(byte_stream_two_writes)
 ttest(byte_stream_many_writes)
 ttest(byte_stream_stress_test)
+ttest(byte_stream_push_from)
+ttest(buffer_pool)
 
-ttest(reassembler_single)
-ttest(reassembler_cap)
-ttest(reassembler_seq)
-ttest(reassembler_dup)
-ttest(reassembler_holes)
-ttest(reassembler_overlapping)
-ttest(reassembler_win)
+rtest(reassembler_single)
+rtest(reassembler_cap)
+rtest(reassembler_seq)
+rtest(reassembler_dup)
+rtest(reassembler_holes)
+rtest(reassembler_overlapping)
+rtest(reassembler_win)
 
 ttest(wrapping_integers_cmp)
 ttest(wrapping_integers_wrap)
@@ -44,10 +55,14 @@ ttest(wrapping_integers_extra)
 ttest(recv_connect)
 ttest(recv_transmit)
 ttest(recv_window)
-ttest(recv_reorder)
-ttest(recv_reorder_more)
+rtest(recv_reorder)
+rtest(recv_reorder_more)
 ttest(recv_close)
 ttest(recv_special)
+ttest(recv_timestamps)
+ttest(checksum)
+ttest(tcp_segment)
+ttest(peer_delayed_ack)
 
 ttest(send_connect)
 ttest(send_transmit)
@@ -56,6 +71,13 @@ ttest(send_window)
 ttest(send_ack)
 ttest(send_close)
 ttest(send_extra)
+ttest(send_congestion)
+ttest(send_rto)
+ttest(send_fast_retx)
+ttest(send_sack)
+ttest(send_mss)
+ttest(send_pacing)
+ttest(send_nagle)
 
 ttest(net_interface)
 
@@ -95,3 +117,7 @@ set_tests_properties(${compile_name_opt} PROPERTIES FIXTURES_SETUP compile_opt)
 
 stest(byte_stream_speed_test)
 stest(reassembler_speed_test)
+stest(handoff_speed_test)
+stest(nagle_speed_test)
+stest(checksum_speed_test)
+stest(parser_speed_test)
@@ -1,8 +1,15 @@
 #include "byte_stream.hh"
+#include "buffer_pool.hh"
+#include "file_descriptor.hh"
+
+#include <array>
+#include <span>
 
 using namespace std;
 
-ByteStream::ByteStream( uint64_t const capacity ) : capacity_( capacity ) {}
+ByteStream::ByteStream( uint64_t const capacity, Storage const storage )
+  : capacity_( capacity ), storage_( storage ), ring_( storage == Storage::Ring ? capacity : 0, '\0' )
+{}
 
 bool Writer::is_closed() const
 {
@@ -11,11 +18,25 @@ bool Writer::is_closed() const
 
 void Writer::push( string data )
 {
+  if ( storage_ == Storage::Ring ) {
+    return push_to_ring( data );
+  }
+  if ( data.size() > available_capacity() ) {
+    data.resize( available_capacity() );
+  }
+  push( Buffer { std::move( data ) } );
+}
+
+void Writer::push( Buffer data )
+{
+  if ( storage_ == Storage::Ring ) {
+    return push_to_ring( data );
+  }
   if ( is_closed() or available_capacity() == 0 or data.empty() ) {
     return;
   }
   if ( data.size() > available_capacity() ) {
-    data.resize( available_capacity() );
+    data = data.substr( 0, available_capacity() );
   }
   bytes_pushed_ += data.size();
   bytes_available_ += data.size();
@@ -23,6 +44,52 @@ void Writer::push( string data )
   buffers_.emplace_back( std::move( data ) );
 }
 
+void Writer::push_to_ring( string_view data )
+{
+  if ( is_closed() or available_capacity() == 0 or data.empty() ) {
+    return;
+  }
+  data = data.substr( 0, available_capacity() );
+  std::size_t const tail { ( ring_head_ + bytes_available_ ) % capacity_ };
+  std::size_t const first { std::min( data.size(), capacity_ - tail ) };
+  data.copy( ring_.data() + tail, first );
+  data.copy( ring_.data(), data.size() - first, first );
+  bytes_pushed_ += data.size();
+  bytes_available_ += data.size();
+}
+
+uint64_t Writer::push_from( FileDescriptor& fd )
+{
+  if ( is_closed() or available_capacity() == 0 ) {
+    return 0;
+  }
+
+  if ( storage_ == Storage::Ring ) {
+    // the free space is [tail, end of ring) followed by [0, head)
+    std::size_t const tail { ( ring_head_ + bytes_available_ ) % capacity_ };
+    std::size_t const first { std::min( available_capacity(), capacity_ - tail ) };
+    std::array<std::span<char>, 2> const free_space { std::span { ring_.data() + tail, first },
+                                                      std::span { ring_.data(), available_capacity() - first } };
+    std::size_t const len { fd.read( std::span { free_space }.first( free_space[1].empty() ? 1 : 2 ) ) };
+    bytes_pushed_ += len;
+    bytes_available_ += len;
+    return len;
+  }
+
+  auto& pool { BufferPool::local() };
+  uint64_t const max_chunk { uint64_t { 1 } << BufferPool::MAX_CLASS_LOG2 };
+  std::string chunk { pool.acquire( std::min( available_capacity(), max_chunk ) ) };
+  chunk.resize( std::min<uint64_t>( chunk.capacity(), available_capacity() ) );
+  std::size_t const len { fd.read( std::array { std::span { chunk } } ) };
+  if ( len == 0 ) {
+    pool.release( std::move( chunk ) );
+    return 0;
+  }
+  chunk.resize( len );
+  push( std::move( chunk ) );
+  return len;
+}
+
 void Writer::close()
 {
   closed_ = true;
@@ -59,6 +126,10 @@ uint64_t Reader::bytes_popped() const
 
 string_view Reader::peek() const
 {
+  if ( storage_ == Storage::Ring ) {
+    // the largest contiguous run, i.e. up to the physical end of the ring
+    return std::string_view { ring_ }.substr( ring_head_, std::min( bytes_available_, capacity_ - ring_head_ ) );
+  }
   if ( buffers_.empty() ) {
     return {};
   }
@@ -67,17 +138,50 @@ string_view Reader::peek() const
   return peeked; // NOLINT
 }
 
+Buffer Reader::peek_buffer() const
+{
+  if ( storage_ == Storage::Ring or buffers_.empty() ) {
+    return string { peek() };
+  }
+  return buffers_.front().substr( pop_prefix_ );
+}
+
+vector<string_view> Reader::peek_all( uint64_t max_bytes ) const
+{
+  vector<string_view> views;
+  max_bytes = std::min( max_bytes, bytes_available_ );
+  if ( storage_ == Storage::Ring ) {
+    for ( std::size_t pos { ring_head_ }; max_bytes != 0; pos = 0 ) {
+      views.emplace_back( std::string_view { ring_ }.substr( pos, std::min( max_bytes, capacity_ - pos ) ) );
+      max_bytes -= views.back().size();
+    }
+    return views;
+  }
+  std::size_t skip { pop_prefix_ };
+  for ( auto it { buffers_.begin() }; max_bytes != 0; ++it, skip = 0 ) {
+    views.emplace_back( std::string_view { *it }.substr( skip, max_bytes ) );
+    max_bytes -= views.back().size();
+  }
+  return views;
+}
+
 void Reader::pop( uint64_t len )
 {
   len = std::min( len, bytes_available_ );
   bytes_available_ -= len;
   bytes_popped_ += len;
+  if ( storage_ == Storage::Ring ) {
+    // rewind an empty ring so that the next peek() sees one contiguous run
+    ring_head_ = bytes_available_ == 0 ? 0 : ( ring_head_ + len ) % capacity_;
+    return;
+  }
   while ( len != 0LU ) {
     std::size_t const size { buffers_.front().size() - pop_prefix_ };
     if ( len < size ) {
       pop_prefix_ += len;
       break; // with len = 0;
     }
+    BufferPool::local().release( buffers_.front().reclaim() );
     buffers_.pop_front();
     pop_prefix_ = 0;
     len -= size;
@@ -1,17 +1,28 @@
 #pragma once
 
+#include "buffer.hh"
+
 #include <cstdint>
 #include <deque>
 #include <string>
 #include <string_view>
+#include <vector>
 
+class FileDescriptor;
 class Reader;
 class Writer;
 
 class ByteStream
 {
 public:
-  explicit ByteStream( uint64_t capacity );
+  // How the buffered bytes are stored: a deque of pushed chunks, or one contiguous ring allocated at `capacity`.
+  enum class Storage : uint8_t
+  {
+    Chunked,
+    Ring,
+  };
+
+  explicit ByteStream( uint64_t capacity, Storage storage = Storage::Chunked );
 
   // Helper functions (provided) to access the ByteStream's Reader and Writer interfaces
   Reader& reader();
@@ -22,25 +33,34 @@ public:
   [[nodiscard]] const Writer& writer() const;
   [[nodiscard]] bool has_error() const { return error_; } // Has the stream had an error?
   [[nodiscard]] size_t capacity() const { return capacity_; }
+  [[nodiscard]] Storage storage() const { return storage_; }
 
 protected:
   // Please add any additional state to the ByteStream here, and not to the Writer and Reader interfaces.
   bool error_ {};
   bool closed_ {};
   std::size_t capacity_;
+  Storage storage_;
   std::size_t pop_prefix_ {}; // 一个字符串中popped但没完全popped的部分
   std::size_t bytes_popped_ {};
   std::size_t bytes_pushed_ {};
   std::size_t bytes_available_ {};
-  std::deque<std::string> buffers_ {};
+  std::deque<Buffer> buffers_ {};
+  std::size_t ring_head_ {}; // index in ring_ of the first unpopped byte (Storage::Ring only)
+  std::string ring_ {};      // fixed-size ring of `capacity_` bytes (Storage::Ring only)
 };
 
 class Writer : public ByteStream
 {
 public:
   void push( std::string data ); // Push data to stream, but only as much as available capacity allows.
+  void push( Buffer data );      // Same, but a chunked stream keeps a reference instead of copying the bytes.
   void close();                  // Signal that the stream has reached its ending. Nothing more will be written.
 
+  // Read from `fd` straight into the stream's free space (ring: one readv() into the free segments;
+  // chunked: into a pooled chunk of at most 64 KiB). Returns the number of bytes pushed.
+  uint64_t push_from( FileDescriptor& fd );
+
   [[nodiscard]] bool is_full() const;                // Has the stream been closed?
   [[nodiscard]] bool is_closed() const;              // Has the stream been closed?
   [[nodiscard]] uint64_t available_capacity() const; // How many bytes can be pushed to the stream right now?
@@ -48,6 +68,9 @@ public:
   [[nodiscard]] uint64_t capacity() const;           // How many bytes can be pushed to the stream right now?
   [[nodiscard]] inline uint64_t write_index() const { return bytes_pushed(); }
   [[nodiscard]] inline uint64_t right_bound() const { return write_index() + available_capacity(); }
+
+private:
+  void push_to_ring( std::string_view data ); // Copy into the ring (Storage::Ring only)
 };
 
 class Reader : public ByteStream
@@ -56,6 +79,9 @@ public:
   void pop( uint64_t len ); // Remove `len` bytes from the buffer
 
   [[nodiscard]] std::string_view peek() const;   // Peek at the next bytes in the buffer
+  [[nodiscard]] Buffer peek_buffer() const;      // Same bytes as peek(), shared (not copied) if chunked
+  // Peek at (up to `max_bytes` of) everything buffered, one view per stored segment, e.g. for a single writev()
+  [[nodiscard]] std::vector<std::string_view> peek_all( uint64_t max_bytes = UINT64_MAX ) const;
   [[nodiscard]] bool is_finished() const;        // Is the stream finished (closed and fully popped)?
   [[nodiscard]] uint64_t bytes_buffered() const; // Number of bytes currently buffered (pushed and not popped)
   [[nodiscard]] uint64_t bytes_popped() const;   // Total number of bytes cumulatively popped from stream
@@ -66,3 +92,9 @@ public:
  * from a ByteStream Reader into a string;
  */
 void read( Reader& reader, uint64_t len, std::string& out );
+
+/*
+ * read: Same, but into a Buffer. When the bytes come from a single pushed chunk,
+ * `out` shares that chunk's allocation instead of copying it.
+ */
+void read( Reader& reader, uint64_t len, Buffer& out );
@@ -1,5 +1,6 @@
 #include "byte_stream.hh"
 
+#include <algorithm>
 #include <cstdint>
 #include <stdexcept>
 
@@ -24,6 +25,21 @@ void read( Reader& reader, uint64_t len, std::string& out )
   }
 }
 
+void read( Reader& reader, uint64_t len, Buffer& out )
+{
+  len = std::min( len, reader.bytes_buffered() );
+  Buffer front { reader.peek_buffer() };
+  if ( front.size() >= len ) {
+    out = front.substr( 0, len ); // zero-copy: `len` bytes of the front chunk
+    reader.pop( len );
+    return;
+  }
+
+  std::string bytes;
+  read( reader, len, bytes ); // the bytes span several chunks, so concatenate them once
+  out = std::move( bytes );
+}
+
 Reader& ByteStream::reader()
 {
   static_assert( sizeof( Reader ) == sizeof( ByteStream ),
@@ -0,0 +1,126 @@
+#include "congestion_control.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+unique_ptr<CongestionControl> CongestionControl::make( Algorithm const algorithm, uint64_t const mss )
+{
+  switch ( algorithm ) {
+    case Algorithm::Reno:
+      return make_unique<Reno>( mss );
+    case Algorithm::Cubic:
+      return make_unique<Cubic>( mss );
+    case Algorithm::None:
+      break;
+  }
+  return nullptr;
+}
+
+CongestionControl::CongestionControl( uint64_t const mss ) : mss_ { mss }, cwnd_ { initial_window( mss ) } {}
+
+uint64_t CongestionControl::initial_window( uint64_t const mss )
+{
+  return mss > 2190 ? 2 * mss : mss > 1095 ? 3 * mss : 4 * mss;
+}
+
+void CongestionControl::set_mss( uint64_t const mss )
+{
+  mss_ = mss;
+  cwnd_ = initial_window( mss );
+}
+
+void CongestionControl::slow_start( uint64_t const bytes_acked )
+{
+  cwnd_ += min( bytes_acked, 2 * mss_ );
+}
+
+void Reno::on_ack( uint64_t const bytes_acked,
+                   uint64_t const bytes_in_flight [[maybe_unused]],
+                   uint64_t const now_ms [[maybe_unused]] )
+{
+  if ( in_slow_start() ) {
+    slow_start( bytes_acked );
+    return;
+  }
+
+  // congestion avoidance: one MSS per window's worth of acknowledged bytes
+  bytes_acked_ += bytes_acked;
+  while ( bytes_acked_ >= cwnd_ ) {
+    bytes_acked_ -= cwnd_;
+    cwnd_ += mss_;
+  }
+}
+
+void Reno::on_loss( uint64_t const bytes_in_flight, uint64_t const now_ms [[maybe_unused]] )
+{
+  ssthresh_ = max( bytes_in_flight / 2, 2 * mss_ );
+  cwnd_ = ssthresh_;
+  bytes_acked_ = 0;
+}
+
+void Reno::on_rto( uint64_t const bytes_in_flight, uint64_t const now_ms [[maybe_unused]] )
+{
+  ssthresh_ = max( bytes_in_flight / 2, 2 * mss_ );
+  cwnd_ = mss_;
+  bytes_acked_ = 0;
+}
+
+void Cubic::on_ack( uint64_t const bytes_acked,
+                    uint64_t const bytes_in_flight [[maybe_unused]],
+                    uint64_t const now_ms )
+{
+  if ( in_slow_start() ) {
+    slow_start( bytes_acked );
+    return;
+  }
+
+  auto const mss { static_cast<double>( mss_ ) };
+  auto const segments { static_cast<double>( cwnd_ ) / mss };
+
+  if ( not in_epoch_ ) {
+    in_epoch_ = true;
+    epoch_start_ms_ = now_ms;
+    origin_ = max( w_max_, segments );
+    k_ = cbrt( ( origin_ - segments ) / C );
+    w_est_ = segments;
+  }
+
+  // W_cubic(t), limited to growing by half the window at a time (RFC 9438 section 4.2)
+  double const t { static_cast<double>( now_ms - epoch_start_ms_ ) / 1000.0 };
+  double target { clamp( origin_ + C * pow( t - k_, 3 ), segments, 1.5 * segments ) };
+
+  // never grow slower than standard Reno would (RFC 9438 section 4.3)
+  constexpr double alpha { 3.0 * ( 1.0 - BETA ) / ( 1.0 + BETA ) };
+  w_est_ += alpha * ( static_cast<double>( bytes_acked ) / mss ) / segments;
+  target = max( target, w_est_ );
+
+  growth_ += ( target - segments ) * static_cast<double>( bytes_acked ) / segments;
+  auto const whole_bytes { static_cast<uint64_t>( growth_ ) };
+  cwnd_ += whole_bytes;
+  growth_ -= static_cast<double>( whole_bytes );
+}
+
+void Cubic::reduce()
+{
+  auto const segments { static_cast<double>( cwnd_ ) / static_cast<double>( mss_ ) };
+
+  // fast convergence: release bandwidth sooner if the plateau keeps dropping
+  w_max_ = segments < w_max_ ? segments * ( 1.0 + BETA ) / 2.0 : segments;
+  ssthresh_ = max( static_cast<uint64_t>( static_cast<double>( cwnd_ ) * BETA ), 2 * mss_ );
+  in_epoch_ = false;
+  growth_ = 0;
+}
+
+void Cubic::on_loss( uint64_t const bytes_in_flight [[maybe_unused]], uint64_t const now_ms [[maybe_unused]] )
+{
+  reduce();
+  cwnd_ = ssthresh_;
+}
+
+void Cubic::on_rto( uint64_t const bytes_in_flight [[maybe_unused]], uint64_t const now_ms [[maybe_unused]] )
+{
+  reduce();
+  cwnd_ = mss_;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string_view>
+
+/*
+ * CongestionControl: the sender's congestion window (cwnd) and slow-start threshold (ssthresh), in bytes.
+ * The TCPSender reports acknowledgments, losses and retransmission timeouts; the algorithm adjusts the
+ * window, and the sender keeps no more than min(cwnd, receiver's window) bytes in flight.
+ */
+class CongestionControl
+{
+public:
+  enum class Algorithm : uint8_t
+  {
+    None, // only the receiver's window limits the sender
+    Reno, // RFC 5681
+    Cubic // RFC 9438
+  };
+
+  /* The algorithm's state for a connection sending segments of at most `mss` bytes (nullptr for None) */
+  static std::unique_ptr<CongestionControl> make( Algorithm algorithm, uint64_t mss );
+
+  virtual ~CongestionControl() = default;
+
+  /* `bytes_acked` newly acknowledged payload bytes, at time `now_ms` */
+  virtual void on_ack( uint64_t bytes_acked, uint64_t bytes_in_flight, uint64_t now_ms ) = 0;
+
+  /* A segment was inferred lost (e.g. from duplicate acknowledgments) */
+  virtual void on_loss( uint64_t bytes_in_flight, uint64_t now_ms ) = 0;
+
+  /* The retransmission timer expired */
+  virtual void on_rto( uint64_t bytes_in_flight, uint64_t now_ms ) = 0;
+
+  [[nodiscard]] virtual std::string_view name() const = 0;
+
+  /* The connection settled on a different MSS (e.g. the peer's MSS option) before sending any data */
+  void set_mss( uint64_t mss );
+
+  [[nodiscard]] uint64_t cwnd() const { return cwnd_; }
+  [[nodiscard]] uint64_t ssthresh() const { return ssthresh_; }
+  [[nodiscard]] bool in_slow_start() const { return cwnd_ < ssthresh_; }
+
+protected:
+  explicit CongestionControl( uint64_t mss );
+  CongestionControl( const CongestionControl& ) = default;
+  CongestionControl& operator=( const CongestionControl& ) = default;
+
+  /* RFC 5681 section 3.1 */
+  static uint64_t initial_window( uint64_t mss );
+
+  /* Grow cwnd by the bytes acknowledged, at most 2 * MSS per ACK (RFC 3465) */
+  void slow_start( uint64_t bytes_acked );
+
+  uint64_t mss_;
+  uint64_t cwnd_;
+  uint64_t ssthresh_ { std::numeric_limits<uint64_t>::max() };
+};
+
+class Reno : public CongestionControl
+{
+public:
+  explicit Reno( uint64_t mss ) : CongestionControl( mss ) {}
+
+  void on_ack( uint64_t bytes_acked, uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  void on_loss( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  void on_rto( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  [[nodiscard]] std::string_view name() const override { return "reno"; }
+
+private:
+  uint64_t bytes_acked_ {}; // in congestion avoidance, acknowledged since cwnd last grew
+};
+
+class Cubic : public CongestionControl
+{
+public:
+  static constexpr double C = 0.4;
+  static constexpr double BETA = 0.7;
+
+  explicit Cubic( uint64_t mss ) : CongestionControl( mss ) {}
+
+  void on_ack( uint64_t bytes_acked, uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  void on_loss( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  void on_rto( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  [[nodiscard]] std::string_view name() const override { return "cubic"; }
+
+private:
+  void reduce();
+
+  bool in_epoch_ {};           // has congestion avoidance started since the last reduction?
+  uint64_t epoch_start_ms_ {}; // when it started
+  double w_max_ {};            // cwnd (in segments) just before the last reduction
+  double k_ {};                // seconds from the epoch start until the cubic curve reaches its origin
+  double origin_ {};           // the curve's plateau, in segments
+  double w_est_ {};            // the window standard Reno would have, in segments
+  double growth_ {};           // fractional bytes of cwnd growth not yet applied
+};
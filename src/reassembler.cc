@@ -1,7 +1,11 @@
 #include "reassembler.hh"
+#include "buffer_pool.hh"
 
+#include <algorithm>
+#include <bit>
 #include <ranges>
 #include <string>
+#include <tuple>
 
 #define RAII_CLOSE                                                                                                 \
   [&]() noexcept -> void {                                                                                         \
@@ -10,6 +14,13 @@
     }                                                                                                              \
   }
 
+Reassembler::Reassembler( ByteStream&& output, Engine const engine )
+  : output_ { std::move( output ) }
+  , engine_ { engine }
+  , window_( engine == Engine::Bitmap ? output_.capacity() : 0, '\0' )
+  , occupied_( engine == Engine::Bitmap ? ( output_.capacity() + 63 ) / 64 : 0 )
+{}
+
 auto Reassembler::split( uint64_t pos ) noexcept
 {
   auto const& it { buf_.lower_bound( pos ) };
@@ -20,7 +31,9 @@ auto Reassembler::split( uint64_t pos ) noexcept
     return it;
   }
   if ( auto& [offset, frame] { *std::prev( it ) }; offset + frame.length() > pos ) {
-    const auto& res { buf_.emplace_hint( it, pos, frame.substr( pos - offset ) ) };
+    std::string tail { BufferPool::local().acquire( offset + frame.length() - pos ) };
+    tail.append( frame, pos - offset );
+    const auto& res { buf_.emplace_hint( it, pos, std::move( tail ) ) };
     frame.resize( pos - offset );
     return res;
   }
@@ -35,35 +48,159 @@ bool Reassembler::writable() const noexcept
 void Reassembler::insert( uint64_t offset, std::string data, bool is_eof )
 {
   std::string_view sv { data };
+  if ( not clip( offset, sv, is_eof ) ) {
+    BufferPool::local().release( std::move( data ) );
+    return RAII_CLOSE();
+  }
+  trim( data, sv );
+
+  // fast path: the next bytes of the stream go straight to the output
+  if ( offset == writer().write_index() ) [[likely]] {
+    ++stats_.in_order;
+    push_in_order( std::move( data ) );
+  } else {
+    ++stats_.out_of_order;
+    store( offset, std::move( data ) );
+  }
+  return RAII_CLOSE();
+}
+
+void Reassembler::insert_batch( std::span<Segment> segments )
+{
+  // The window [write index, right bound) stays put until something is pushed, so every substring
+  // can be clipped up front; then coalesce them in offset order and push (at most) once, at the end.
+  std::vector<std::pair<uint64_t, std::string*>> clipped;
+  clipped.reserve( segments.size() );
+  for ( auto& [first_index, data, is_last_substring] : segments ) {
+    uint64_t offset { first_index };
+    std::string_view sv { data };
+    if ( clip( offset, sv, is_last_substring ) ) {
+      trim( data, sv );
+      clipped.emplace_back( offset, &data );
+    }
+  }
+  std::ranges::stable_sort( clipped, {}, &std::pair<uint64_t, std::string*>::first );
+
+  auto& pool { BufferPool::local() };
+  std::string in_order {};
+  for ( auto it { clipped.begin() }; it != clipped.end(); ) {
+    uint64_t const offset { it->first };
+    std::string run { std::move( *it->second ) };
+    uint64_t count { 1 };
+    // absorb every following substring that overlaps or abuts this run
+    for ( ++it; it != clipped.end() and it->first <= offset + run.length(); ++it, ++count ) {
+      uint64_t const run_end { offset + run.length() };
+      if ( it->first + it->second->length() > run_end ) {
+        run.append( *it->second, run_end - it->first );
+      }
+      pool.release( std::move( *it->second ) );
+    }
+
+    if ( offset == writer().write_index() ) {
+      stats_.in_order += count;
+      in_order = std::move( run );
+    } else {
+      stats_.out_of_order += count;
+      store( offset, std::move( run ) );
+    }
+  }
+
+  if ( not in_order.empty() ) {
+    push_in_order( std::move( in_order ) );
+  }
+  return RAII_CLOSE();
+}
+
+// Clip a substring to the window [write index, right bound), noting where the stream ends.
+// Returns false if nothing of it is left to store or push.
+bool Reassembler::clip( uint64_t& offset, std::string_view& sv, bool is_eof )
+{
   if ( sv.empty() ) [[unlikely]] {
     if ( end_index_ == UINT64_MAX and is_eof ) {
       end_index_ = offset;
     }
-    return RAII_CLOSE();
+    return false;
   }
   if ( written( sv, offset ) or not writable() ) [[unlikely]] {
-    return;
+    ++stats_.discarded;
+    return false;
   }
   if ( offset < writer().write_index() ) {
     sv.remove_prefix( writer().write_index() - offset );
     offset = writer().write_index();
   }
   if ( offset + sv.length() > writer().right_bound() ) {
-    sv.remove_suffix( writer().right_bound() - offset );
+    sv.remove_suffix( offset + sv.length() - writer().right_bound() );
     is_eof = false;
   }
   if ( end_index_ == UINT64_MAX and is_eof ) {
     end_index_ = offset + sv.length();
   }
+  return true;
+}
+
+// Cut `data` down to `part` (a view into it) in place, keeping the allocation
+void Reassembler::trim( std::string& data, std::string_view const part )
+{
+  std::size_t const skip ( part.data() - data.data() );
+  std::size_t const length { part.length() };
+  data.resize( skip + length );
+  data.erase( 0, skip );
+}
+
+// Push bytes that begin at the write index
+void Reassembler::push_in_order( std::string data )
+{
+  if ( engine_ == Engine::Bitmap ) {
+    // forget whatever was stored for those bytes
+    std::size_t const slot { writer().write_index() % window_.size() };
+    std::size_t const first { std::min( data.length(), window_.size() - slot ) };
+    total_pending_ -= vacate( slot, slot + first ) + vacate( 0, data.length() - first );
+    writer().push( std::move( data ) );
+    return flush_window();
+  }
+
+  writer().push( std::move( data ) );
+
+  // drop whatever the stored fragments held of those bytes, without re-splitting the map
+  uint64_t const end { writer().write_index() };
+  while ( not buf_.empty() and buf_.begin()->first < end ) {
+    auto node { buf_.extract( buf_.begin() ) };
+    std::string& fragment { node.mapped() };
+    if ( node.key() + fragment.length() <= end ) {
+      total_pending_ -= fragment.length();
+      BufferPool::local().release( std::move( fragment ) );
+      continue;
+    }
+    total_pending_ -= end - node.key();
+    fragment.erase( 0, end - node.key() );
+    node.key() = end;
+    buf_.insert( std::move( node ) );
+  }
+  flush_map();
+}
 
-  const auto upper { split( offset + sv.length() ) };
+// Hold bytes that begin beyond the write index
+void Reassembler::store( uint64_t const offset, std::string data )
+{
+  if ( engine_ == Engine::Bitmap ) {
+    store_in_window( offset, data );
+    return BufferPool::local().release( std::move( data ) );
+  }
+
+  const auto upper { split( offset + data.length() ) };
   const auto lower { split( offset ) };
-  for ( std::string const& str : std::ranges::subrange { lower, upper } | std::views::values ) {
+  for ( std::string& str : std::ranges::subrange { lower, upper } | std::views::values ) {
     total_pending_ -= str.size();
+    BufferPool::local().release( std::move( str ) );
   }
-  total_pending_ += sv.length();
-  buf_.emplace_hint( buf_.erase( lower, upper ), offset, sv );
+  total_pending_ += data.length();
+  buf_.emplace_hint( buf_.erase( lower, upper ), offset, std::move( data ) );
+}
 
+// Push the stored fragments that now begin at the write index
+void Reassembler::flush_map()
+{
   while ( not buf_.empty() ) {
     auto& [idx, payload] { *buf_.begin() };
     if ( idx not_eq writer().bytes_pushed() ) {
@@ -73,7 +210,135 @@ void Reassembler::insert( uint64_t offset, std::string data, bool is_eof )
     writer().push( std::move( payload ) );
     buf_.erase( buf_.begin() );
   }
-  return RAII_CLOSE();
+}
+
+void Reassembler::store_in_window( uint64_t const offset, std::string_view const data )
+{
+  std::size_t const slot { offset % window_.size() };
+  std::size_t const first { std::min( data.length(), window_.size() - slot ) };
+  data.copy( window_.data() + slot, first );
+  data.copy( window_.data(), data.length() - first, first );
+  total_pending_ += occupy( slot, slot + first ) + occupy( 0, data.length() - first );
+}
+
+void Reassembler::flush_window()
+{
+  std::size_t const slot { writer().write_index() % window_.size() };
+  std::size_t const run { occupied_run( slot, window_.size() ) };
+  std::size_t const wrapped { slot + run == window_.size() ? occupied_run( 0, slot ) : 0 };
+  if ( run + wrapped == 0 ) {
+    return;
+  }
+
+  std::string bytes { BufferPool::local().acquire( run + wrapped ) };
+  bytes.append( window_, slot, run ).append( window_, 0, wrapped );
+  total_pending_ -= vacate( slot, slot + run ) + vacate( 0, wrapped );
+  writer().push( std::move( bytes ) );
+}
+
+// Mark slots [begin, end) of the window as pending, returning how many were not already
+uint64_t Reassembler::occupy( std::size_t begin, std::size_t const end ) noexcept
+{
+  uint64_t added {};
+  while ( begin < end ) {
+    std::size_t const bit { begin % 64 };
+    std::size_t const n { std::min( 64 - bit, end - begin ) };
+    uint64_t const mask { ( n == 64 ? ~uint64_t {} : ( uint64_t { 1 } << n ) - 1 ) << bit };
+    uint64_t& word { occupied_[begin / 64] };
+    added += std::popcount( mask & ~word );
+    word |= mask;
+    begin += n;
+  }
+  return added;
+}
+
+// Mark slots [begin, end) of the window as free, returning how many were pending
+uint64_t Reassembler::vacate( std::size_t begin, std::size_t const end ) noexcept
+{
+  uint64_t removed {};
+  while ( begin < end ) {
+    std::size_t const bit { begin % 64 };
+    std::size_t const n { std::min( 64 - bit, end - begin ) };
+    uint64_t const mask { ( n == 64 ? ~uint64_t {} : ( uint64_t { 1 } << n ) - 1 ) << bit };
+    uint64_t& word { occupied_[begin / 64] };
+    removed += std::popcount( mask & word );
+    word &= ~mask;
+    begin += n;
+  }
+  return removed;
+}
+
+// Length of the run of pending slots starting at `begin`, looking no further than `end`
+std::size_t Reassembler::occupied_run( std::size_t const begin, std::size_t const end ) const noexcept
+{
+  std::size_t pos { begin };
+  while ( pos < end ) {
+    uint64_t const vacant { ~occupied_[pos / 64] >> ( pos % 64 ) };
+    if ( vacant != 0 ) {
+      return std::min<std::size_t>( pos + std::countr_zero( vacant ), end ) - begin;
+    }
+    pos += 64 - pos % 64;
+  }
+  return std::min( pos, end ) - begin;
+}
+
+// First pending slot in [begin, end), or `end` if there is none
+std::size_t Reassembler::next_occupied( std::size_t const begin, std::size_t const end ) const noexcept
+{
+  std::size_t pos { begin };
+  while ( pos < end ) {
+    uint64_t const pending { occupied_[pos / 64] >> ( pos % 64 ) };
+    if ( pending != 0 ) {
+      return std::min<std::size_t>( pos + std::countr_zero( pending ), end );
+    }
+    pos += 64 - pos % 64;
+  }
+  return end;
+}
+
+std::vector<std::pair<uint64_t, uint64_t>> Reassembler::pending_ranges( std::size_t const max_ranges ) const
+{
+  std::vector<std::pair<uint64_t, uint64_t>> ranges;
+  auto const add { [&]( uint64_t first, uint64_t end ) {
+    if ( not ranges.empty() and ranges.back().second == first ) {
+      ranges.back().second = end;
+    } else if ( ranges.size() < max_ranges ) {
+      ranges.emplace_back( first, end );
+    } else {
+      return false;
+    }
+    return true;
+  } };
+
+  if ( engine_ == Engine::Map ) {
+    for ( auto const& [first, fragment] : buf_ ) {
+      if ( not add( first, first + fragment.length() ) ) {
+        break;
+      }
+    }
+    return ranges;
+  }
+
+  if ( total_pending_ == 0 ) {
+    return ranges;
+  }
+  // the window's slots from the write index up to the right bound, in up to two pieces
+  uint64_t const base { writer().write_index() };
+  std::size_t const slot { base % window_.size() };
+  std::size_t const span { writer().available_capacity() };
+  std::size_t const first_piece { std::min( span, window_.size() - slot ) };
+  for ( auto const& [begin, end, index] :
+        { std::tuple { slot, slot + first_piece, base },
+          std::tuple { std::size_t {}, span - first_piece, base + first_piece } } ) {
+    for ( std::size_t pos { next_occupied( begin, end ) }; pos < end; ) {
+      std::size_t const run { occupied_run( pos, end ) };
+      if ( not add( index + ( pos - begin ), index + ( pos - begin ) + run ) ) {
+        return ranges;
+      }
+      pos = next_occupied( pos + run, end );
+    }
+  }
+  return ranges;
 }
 
 bool Reassembler::written( std::string_view const data, size_t const offset ) const noexcept
@@ -4,12 +4,25 @@
 
 #include <cstdint>
 #include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 class Reassembler
 {
 public:
+  // How out-of-order bytes are held: a map of (possibly split) fragments, or a ring the size of the output's
+  // capacity plus an occupancy bitmap (one bit per byte), which makes heavy reordering cost memcpy and bit ops.
+  enum class Engine : uint8_t
+  {
+    Map,
+    Bitmap,
+  };
+
   // Construct Reassembler to write into given ByteStream.
-  explicit Reassembler( ByteStream&& output ) : output_ { std::move( output ) } {}
+  explicit Reassembler( ByteStream&& output, Engine engine = Engine::Map );
 
   [[nodiscard]] bool writable() const noexcept;
   /*
@@ -34,11 +47,40 @@ public:
    */
   void insert( uint64_t offset, std::string data, bool is_eof );
 
+  // A substring for insert_batch()
+  struct Segment
+  {
+    uint64_t first_index {};
+    std::string data {};
+    bool is_last_substring {};
+  };
+
+  /*
+   * Insert a burst of substrings at once (same result as inserting them one at a time, in order).
+   * They are clipped to the window, sorted by index and coalesced in one pass, and whatever becomes
+   * writable is pushed to the ByteStream once. The segments' data is consumed.
+   */
+  void insert_batch( std::span<Segment> segments );
+
   [[nodiscard]] bool written( std::string_view data, size_t offset ) const noexcept;
 
   // How many bytes are stored in the Reassembler itself?
   [[nodiscard]] uint64_t bytes_pending() const;
 
+  // The stored bytes as (up to `max_ranges`) maximal [first, end) ranges of stream indices, lowest first
+  [[nodiscard]] std::vector<std::pair<uint64_t, uint64_t>> pending_ranges( size_t max_ranges ) const;
+
+  [[nodiscard]] Engine engine() const { return engine_; }
+
+  // How many (non-empty) substrings took each path through insert()
+  struct Stats
+  {
+    uint64_t in_order {};     // started at the write index and went straight to the output
+    uint64_t out_of_order {}; // had to be stored
+    uint64_t discarded {};    // entirely already written, or entirely beyond the available capacity
+  };
+  [[nodiscard]] const Stats& stats() const { return stats_; }
+
   // Access output stream reader
   Reader& reader() { return output_.reader(); }
   [[nodiscard]] const Reader& reader() const { return output_.reader(); }
@@ -50,10 +92,27 @@ private:
   [[nodiscard]] Writer& writer() { return output_.writer(); }
 
   ByteStream output_; // the Reassembler writes to this ByteStream
-  std::map<uint64_t, std::string> buf_ {};
+  Engine engine_;
+  std::map<uint64_t, std::string> buf_ {}; // Engine::Map only
+  std::string window_ {};                  // Engine::Bitmap only: byte i of the stream lives at i % capacity
+  std::vector<uint64_t> occupied_ {};      // Engine::Bitmap only: which bytes of window_ are pending
   uint64_t total_pending_ {};
+  Stats stats_ {};
 
   uint64_t end_index_ { UINT64_MAX };
 
   auto split( uint64_t pos ) noexcept;
+
+  bool clip( uint64_t& offset, std::string_view& sv, bool is_eof );
+  static void trim( std::string& data, std::string_view part );
+  void push_in_order( std::string data );
+  void store( uint64_t offset, std::string data );
+  void flush_map();
+
+  void store_in_window( uint64_t offset, std::string_view data );
+  void flush_window();
+  uint64_t occupy( size_t begin, size_t end ) noexcept;
+  uint64_t vacate( size_t begin, size_t end ) noexcept;
+  [[nodiscard]] size_t occupied_run( size_t begin, size_t end ) const noexcept;
+  [[nodiscard]] size_t next_occupied( size_t begin, size_t end ) const noexcept;
 };
\ No newline at end of file
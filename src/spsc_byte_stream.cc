@@ -0,0 +1,103 @@
+#include "spsc_byte_stream.hh"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+// The notifications rely on the tail_/head_ stores being ordered before the subsequent load of the other
+// index (seq_cst): a side that saw the stream empty (or full) and went to sleep is then always woken.
+
+SPSCByteStream::SPSCByteStream( uint64_t const capacity )
+  : capacity_( capacity ), buffer_( make_unique<char[]>( capacity ) )
+{}
+
+uint64_t SPSCByteStream::push( string_view data )
+{
+  if ( is_closed() or has_error() ) {
+    return 0;
+  }
+  uint64_t const tail { tail_.load( memory_order_relaxed ) };
+  uint64_t const len { min<uint64_t>( data.size(), capacity_ - ( tail - head_.load( memory_order_acquire ) ) ) };
+  if ( len == 0 ) {
+    return 0;
+  }
+  uint64_t const pos { tail % capacity_ };
+  uint64_t const first { min( len, capacity_ - pos ) };
+  memcpy( buffer_.get() + pos, data.data(), first );
+  memcpy( buffer_.get(), data.data() + first, len - first );
+  tail_.store( tail + len );
+
+  if ( head_.load() == tail ) {
+    readable_.notify(); // the consumer may have seen an empty stream
+  }
+  return len;
+}
+
+void SPSCByteStream::close()
+{
+  closed_.store( true );
+  readable_.notify();
+}
+
+bool SPSCByteStream::is_closed() const
+{
+  return closed_.load( memory_order_acquire );
+}
+
+uint64_t SPSCByteStream::available_capacity() const
+{
+  return capacity_ - ( tail_.load( memory_order_relaxed ) - head_.load() );
+}
+
+uint64_t SPSCByteStream::bytes_pushed() const
+{
+  return tail_.load( memory_order_acquire );
+}
+
+string_view SPSCByteStream::peek() const
+{
+  uint64_t const head { head_.load( memory_order_relaxed ) };
+  uint64_t const len { tail_.load() - head };
+  if ( len == 0 ) {
+    return {};
+  }
+  uint64_t const pos { head % capacity_ };
+  return { buffer_.get() + pos, min( len, capacity_ - pos ) };
+}
+
+void SPSCByteStream::pop( uint64_t len )
+{
+  uint64_t const head { head_.load( memory_order_relaxed ) };
+  len = min( len, tail_.load( memory_order_acquire ) - head );
+  if ( len == 0 ) {
+    return;
+  }
+  head_.store( head + len );
+
+  if ( tail_.load() - head == capacity_ ) {
+    writable_.notify(); // the producer may have seen a full stream
+  }
+}
+
+bool SPSCByteStream::is_finished() const
+{
+  return is_closed() and bytes_buffered() == 0;
+}
+
+uint64_t SPSCByteStream::bytes_buffered() const
+{
+  return tail_.load() - head_.load( memory_order_relaxed );
+}
+
+uint64_t SPSCByteStream::bytes_popped() const
+{
+  return head_.load( memory_order_acquire );
+}
+
+void SPSCByteStream::set_error()
+{
+  error_.store( true );
+  readable_.notify();
+  writable_.notify();
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "eventfd.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+/*
+ * SPSCByteStream: a fixed-capacity ByteStream that one producer thread and one consumer thread can use
+ * concurrently without locks. The bytes live in a ring allocated once at `capacity`; the producer owns
+ * the tail index and the consumer owns the head index, each on its own cache line.
+ *
+ * Two eventfds let either side sleep in poll(2) instead of spinning: `readable_event()` is notified when
+ * a push makes an empty stream non-empty (or on close/error), and `writable_event()` is notified when a
+ * pop makes a full stream non-full (or on error). A side only needs to wait on its event after it has
+ * observed the stream to be empty (consumer) or full (producer).
+ */
+class SPSCByteStream
+{
+public:
+  explicit SPSCByteStream( uint64_t capacity );
+
+  // Shared between two threads: neither copyable nor movable
+  SPSCByteStream( const SPSCByteStream& ) = delete;
+  SPSCByteStream& operator=( const SPSCByteStream& ) = delete;
+  SPSCByteStream( SPSCByteStream&& ) = delete;
+  SPSCByteStream& operator=( SPSCByteStream&& ) = delete;
+  ~SPSCByteStream() = default;
+
+  // Producer side
+  uint64_t push( std::string_view data ); // Push as much of `data` as fits; returns the number of bytes pushed
+  void close();                           // Signal that nothing more will be pushed
+  [[nodiscard]] bool is_closed() const;
+  [[nodiscard]] uint64_t available_capacity() const;
+  [[nodiscard]] uint64_t bytes_pushed() const;
+
+  // Consumer side
+  [[nodiscard]] std::string_view peek() const; // The largest contiguous run of buffered bytes
+  void pop( uint64_t len );                    // Remove `len` bytes from the buffer
+  [[nodiscard]] bool is_finished() const;      // Closed and fully popped
+  [[nodiscard]] uint64_t bytes_buffered() const;
+  [[nodiscard]] uint64_t bytes_popped() const;
+
+  // Either side
+  void set_error();
+  [[nodiscard]] bool has_error() const { return error_.load( std::memory_order_acquire ); }
+  [[nodiscard]] uint64_t capacity() const { return capacity_; }
+
+  // Readiness notifications, for use with an EventLoop or poll(2)
+  EventFD& readable_event() { return readable_; }
+  EventFD& writable_event() { return writable_; }
+
+private:
+  static constexpr std::size_t CACHE_LINE = 64;
+
+  alignas( CACHE_LINE ) std::atomic<uint64_t> head_ {}; // bytes popped, written by the consumer only
+  alignas( CACHE_LINE ) std::atomic<uint64_t> tail_ {}; // bytes pushed, written by the producer only
+  alignas( CACHE_LINE ) std::atomic_bool closed_ {};
+  std::atomic_bool error_ {};
+
+  uint64_t capacity_;
+  std::unique_ptr<char[]> buffer_;
+  EventFD readable_ {};
+  EventFD writable_ {};
+};
@@ -11,16 +11,67 @@ void TCPReceiver::receive( TCPSenderMessage message )
   }
   uint64_t const checkpoint { writer().bytes_pushed() + 1 /* SYN */ };
   uint64_t const abs_seqno { message.seqno.unwrap( zero_point_.value(), checkpoint ) };
+  if ( not check_timestamp( message, abs_seqno, checkpoint ) ) { return; }
   uint64_t const stream_index { abs_seqno + static_cast<uint64_t>( message.SYN ) - 1 /* SYN */ };
-  reassembler_.insert( stream_index, std::move( message.payload ), message.FIN );
+  reassembler_.insert( stream_index, message.payload.release(), message.FIN );
+}
+
+void TCPReceiver::receive_batch( std::span<TCPSenderMessage> messages )
+{
+  if ( writer().has_error() ) { return; }
+
+  std::vector<Reassembler::Segment> segments;
+  segments.reserve( messages.size() );
+  uint64_t const checkpoint { writer().bytes_pushed() + 1 /* SYN */ }; // nothing is pushed until the batch is in
+  bool reset { false };
+  for ( auto& message : messages ) {
+    if ( message.RST ) {
+      reset = true;
+      break; // the messages before it still count
+    }
+    if ( not zero_point_.has_value() ) {
+      if ( not message.SYN ) { continue; }
+      zero_point_.emplace( message.seqno );
+    }
+    uint64_t const abs_seqno { message.seqno.unwrap( zero_point_.value(), checkpoint ) };
+    if ( not check_timestamp( message, abs_seqno, checkpoint ) ) { continue; }
+    uint64_t const stream_index { abs_seqno + static_cast<uint64_t>( message.SYN ) - 1 /* SYN */ };
+    segments.push_back( { stream_index, message.payload.release(), message.FIN } );
+  }
+
+  reassembler_.insert_batch( segments );
+  if ( reset ) { reader().set_error(); }
 }
 
 TCPReceiverMessage TCPReceiver::send() const
 {
-  uint16_t const window_size = std::min( writer().available_capacity(), (size_t)UINT16_MAX );
-  if ( zero_point_.has_value() ) {
-    uint64_t const ack_for_seqno { writer().bytes_pushed() + 1 + static_cast<uint64_t>( writer().is_closed() ) };
-    return { Wrap32::wrap( ack_for_seqno, zero_point_.value() ), window_size, writer().has_error() };
+  uint64_t const max_window { uint64_t { UINT16_MAX } << window_shift_ };
+  auto const window_size = static_cast<uint32_t>( std::min( writer().available_capacity(), max_window ) );
+  if ( not zero_point_.has_value() ) {
+    return { std::nullopt, window_size, window_shift_, writer().has_error() };
+  }
+
+  uint64_t const ack_for_seqno { writer().bytes_pushed() + 1 + static_cast<uint64_t>( writer().is_closed() ) };
+  TCPReceiverMessage msg { Wrap32::wrap( ack_for_seqno, zero_point_.value() ),
+                           window_size,
+                           window_shift_,
+                           writer().has_error() };
+  for ( auto const& [first, end] : reassembler_.pending_ranges( TCPReceiverMessage::MAX_SACK_BLOCKS ) ) {
+    msg.sack.push_back( { Wrap32::wrap( first + 1, *zero_point_ ), Wrap32::wrap( end + 1, *zero_point_ ) } );
   }
-  return { std::nullopt, window_size, writer().has_error() };
+  msg.TSecr = ts_recent_;
+  return msg;
 }
+
+bool TCPReceiver::check_timestamp( TCPSenderMessage const& message,
+                                   uint64_t const abs_seqno,
+                                   uint64_t const ack_abs_seqno )
+{
+  if ( not message.TSval.has_value() ) { return true; }
+  if ( ts_recent_.has_value() and static_cast<int32_t>( *message.TSval - *ts_recent_ ) < 0 ) {
+    paws_rejected_ += 1;
+    return false;
+  }
+  if ( abs_seqno <= ack_abs_seqno ) { ts_recent_ = message.TSval; } // SEG.SEQ <= Last.ACK.sent
+  return true;
+}
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include "tcp_receiver_message.hh"
 #include "tcp_sender_message.hh"
 
+#include <span>
+
 #define REM( reason ) [[nodiscard( #reason )]]
 
 class TCPReceiver
@@ -18,18 +20,31 @@ public:
    */
   void receive( TCPSenderMessage message );
 
+  // Same as calling receive() on each message in turn, but the payloads go to the Reassembler as one batch.
+  void receive_batch( std::span<TCPSenderMessage> messages );
+
   // The TCPReceiver sends TCPReceiverMessages to the peer's TCPSender.
   REM( 必须处理send的返回值 ) TCPReceiverMessage send() const;
 
+  // Window scaling was negotiated: advertise windows up to UINT16_MAX << shift.
+  void set_window_shift( uint8_t shift ) { window_shift_ = shift; }
+
   // Access the output (only Reader is accessible non-const)
   REM( 不允许忽略 ) const Reassembler& reassembler() const { return reassembler_; }
   Reader& reader() { return reassembler_.reader(); }
   REM() const Reader& reader() const { return reassembler_.reader(); }
   REM() const Writer& writer() const { return reassembler_.writer(); }
+  REM() uint64_t paws_rejected() const { return paws_rejected_; } // old duplicates dropped by PAWS
 
 private:
+  // RFC 7323: PAWS drops a segment whose TSval is older than the last echoed; an in-order one is echoed next
+  bool check_timestamp( TCPSenderMessage const& message, uint64_t abs_seqno, uint64_t ack_abs_seqno );
+
   Reassembler reassembler_;
   std::optional<Wrap32> zero_point_ {};
+  uint8_t window_shift_ {};
+  std::optional<uint32_t> ts_recent_ {}; // TSval to echo in TSecr
+  uint64_t paws_rejected_ {};
 };
 
 #undef REM
\ No newline at end of file
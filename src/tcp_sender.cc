@@ -1,4 +1,5 @@
 #include "tcp_sender.hh"
+#include "buffer_pool.hh"
 #include "tcp_config.hh"
 
 uint64_t TCPSender::sequence_numbers_in_flight() const
@@ -11,10 +12,71 @@ uint64_t TCPSender::consecutive_retransmissions() const
   return total_retransmission_;
 }
 
+uint64_t TCPSender::send_window() const
+{
+  uint64_t const window { std::max( 1U, window_size_ ) };
+  return congestion_control_ ? std::min( window, congestion_control_->cwnd() + recovery_inflation_ ) : window;
+}
+
+void TCPSender::set_peer_mss( uint16_t const peer_mss )
+{
+  if ( ack_abs_seqno_ > 0 ) { return; } // only from the handshake, before any data is in flight
+  mss_ = std::min<uint64_t>( mss_, peer_mss );
+  if ( congestion_control_ ) { congestion_control_->set_mss( mss_ ); }
+}
+
+std::optional<double> TCPSender::srtt_ms() const
+{
+  if ( not rtt_ or not rtt_->has_sample() ) { return std::nullopt; }
+  return rtt_->srtt_ms();
+}
+
+double TCPSender::pacing_rate() const
+{
+  if ( pacing_rate_ ) { return static_cast<double>( pacing_rate_ ) / 1000; }
+  if ( not rtt_ or not rtt_->has_sample() or rtt_->srtt_ms() <= 0 ) { return 0; }
+  bool const slow_start { congestion_control_ and congestion_control_->in_slow_start() };
+  double const gain { slow_start ? Pacer::GAIN_SLOW_START : Pacer::GAIN };
+  return gain * static_cast<double>( send_window() ) / rtt_->srtt_ms();
+}
+
+bool TCPSender::has_new_data() const
+{
+  return not FIN_sent_ and ( not SYN_sent_ or reader().bytes_buffered() > 0 or reader().is_finished() );
+}
+
+std::optional<uint64_t> TCPSender::next_transmit_ms() const
+{
+  double const rate { pacer_ ? pacing_rate() : 0 };
+  if ( rate <= 0 or not has_new_data() or hold_short_segment() or send_window() <= total_outstanding_ ) {
+    return std::nullopt;
+  }
+  return pacer_->wait_ms( rate );
+}
+
+uint64_t TCPSender::base_RTO_ms() const
+{
+  return rtt_ and rtt_->has_sample() ? rtt_->RTO_ms() : initial_RTO_ms_;
+}
+
 void TCPSender::push( const TransmitFunction& transmit )
 {
-  while ( std::max( (uint16_t)1, window_size_ ) > total_outstanding_ ) {
+  // Resend the holes first
+  for ( uint64_t const seqno : lost_ ) {
+    auto& segment { scoreboard_.at( seqno ) };
+    stamp( segment.message );
+    transmit( segment.message );
+    segment.retransmitted = true;
+    fast_retransmissions_ += 1;
+    rtt_probe_.reset(); // Karn's rule
+  }
+  lost_.clear();
+
+  bool const paced { pacer_ and pacing_rate() > 0 };
+  while ( send_window() > total_outstanding_ ) {
     if ( FIN_sent_ ) break; // Is finished.
+    if ( paced and not pacer_->may_send() ) { break; }
+    if ( hold_short_segment() ) { break; }
 
     auto msg { make_empty_message() };
 
@@ -23,8 +85,8 @@ void TCPSender::push( const TransmitFunction& transmit )
       SYN_sent_ = true;
     }
 
-    uint64_t const remaining { ( window_size_ == 0 ? 1 : window_size_ ) - total_outstanding_ };
-    size_t const len { std::min( TCPConfig::MAX_PAYLOAD_SIZE, remaining - msg.sequence_length() ) };
+    uint64_t const remaining { send_window() - total_outstanding_ };
+    size_t const len { std::min( max_payload_size(), remaining - msg.sequence_length() ) };
     read( input_.reader(), len, msg.payload );
 
     if ( not FIN_sent_ and remaining > msg.sequence_length() and reader().is_finished() ) {
@@ -35,16 +97,38 @@ void TCPSender::push( const TransmitFunction& transmit )
     if ( msg.empty() ) { break; }
 
     transmit( msg );
+    if ( paced ) { pacer_->consume( msg.sequence_length() ); }
     if ( not timer_.is_active() ) { timer_.start(); }
     next_abs_seqno_ += msg.sequence_length();
+    if ( rtt_ and not timestamps_ and not rtt_probe_ ) { rtt_probe_.emplace( next_abs_seqno_, now_ms_ ); }
     total_outstanding_ += msg.sequence_length();
-    outstanding_message_.emplace( std::move( msg ) );
+    scoreboard_.emplace( next_abs_seqno_ - msg.sequence_length(), OutstandingSegment { std::move( msg ) } );
   }
 }
 
+bool TCPSender::hold_short_segment() const
+{
+  // A full segment, the SYN and the FIN always go
+  if ( not SYN_sent_ or reader().bytes_buffered() >= mss_ or writer().is_closed() ) { return false; }
+  return corked_ or ( nagle_ and total_outstanding_ > 0 );
+}
+
+void TCPSender::uncork( TransmitFunction const& transmit )
+{
+  corked_ = false;
+  push( transmit );
+}
+
 TCPSenderMessage TCPSender::make_empty_message() const
 {
-  return { Wrap32::wrap( next_abs_seqno_, isn_ ), false, {}, false, input_.has_error() };
+  TCPSenderMessage msg { Wrap32::wrap( next_abs_seqno_, isn_ ), false, {}, false, input_.has_error() };
+  stamp( msg );
+  return msg;
+}
+
+void TCPSender::stamp( TCPSenderMessage& message ) const
+{
+  if ( timestamps_ ) { message.TSval = static_cast<uint32_t>( now_ms_ ); }
 }
 
 void TCPSender::receive( TCPReceiverMessage const& msg )
@@ -52,39 +136,185 @@ void TCPSender::receive( TCPReceiverMessage const& msg )
   if ( msg.RST ) { input_.set_error(); }
   if ( input_.has_error() ) { return; }
 
-  window_size_ = msg.window_size;
+  uint32_t const previous_window_size { std::exchange( window_size_, msg.window_size ) };
   if ( not msg.ackno.has_value() ) { return; }
 
   uint64_t const recv_ack_abs_seqno { msg.ackno->unwrap( isn_, next_abs_seqno_ ) };
   if ( recv_ack_abs_seqno > next_abs_seqno_ ) { return; }
 
+  bool const duplicate { fast_retransmit_ and recv_ack_abs_seqno == ack_abs_seqno_ and not scoreboard_.empty()
+                         and msg.window_size == previous_window_size and msg.window_size != 0 };
+
   bool has_acknowledgment { false };
-  while ( not outstanding_message_.empty() ) {
-    auto const& message { outstanding_message_.front() };
+  uint64_t bytes_acked {};
+  while ( not scoreboard_.empty() ) {
+    auto const front { scoreboard_.begin() };
+    auto& message { front->second.message };
     if ( ack_abs_seqno_ + message.sequence_length() > recv_ack_abs_seqno ) {
       break; // Must be fully acknowledged by the TCP receiver.
     }
     has_acknowledgment = true;
     ack_abs_seqno_ += message.sequence_length();
     total_outstanding_ -= message.sequence_length();
-    outstanding_message_.pop();
+    bytes_acked += message.payload.size();
+    BufferPool::local().release( message.payload.reclaim() ); // the last slice of a pushed chunk frees it
+    sacked_.erase( front->first );
+    lost_.erase( front->first );
+    scoreboard_.erase( front );
+  }
+  if ( super_segments_ and recv_ack_abs_seqno > ack_abs_seqno_ ) {
+    has_acknowledgment = true; // the receiver acknowledges each wire segment of a super-segment
+    bytes_acked += trim_front( recv_ack_abs_seqno );
+  }
+
+  if ( fast_retransmit_ ) {
+    apply_sack( msg.sack );
+    mark_lost();
+    if ( duplicate ) { on_duplicate_ack(); }
+    if ( not in_recovery_ and not lost_.empty() and ack_abs_seqno_ >= recover_ ) { enter_recovery(); }
+  }
+  if ( rtt_probe_ and rtt_probe_->first <= recv_ack_abs_seqno ) {
+    rtt_->sample( now_ms_ - rtt_probe_->second );
+    rtt_probe_.reset();
+  }
+  if ( rtt_ and timestamps_ and msg.TSecr and has_acknowledgment ) {
+    rtt_->sample( static_cast<uint32_t>( now_ms_ ) - *msg.TSecr ); // RFC 7323 section 4.1
   }
   if ( has_acknowledgment ) {
     total_retransmission_ = 0;
-    timer_.reload( initial_RTO_ms_ );
-    outstanding_message_.empty() ? timer_.stop() : timer_.start();
+    dup_acks_ = 0;
+    if ( in_recovery_ ) {
+      on_recovery_ack( bytes_acked );
+    } else if ( congestion_control_ ) {
+      congestion_control_->on_ack( bytes_acked, total_outstanding_, now_ms_ );
+    }
+    timer_.reload( base_RTO_ms() );
+    scoreboard_.empty() ? timer_.stop() : timer_.start();
   }
 }
 
 void TCPSender::tick( uint64_t const ms_since_last_tick, TransmitFunction const& transmit )
 {
-  if ( outstanding_message_.empty() ) { return; }
+  now_ms_ += ms_since_last_tick;
+  retransmit_on_timeout( ms_since_last_tick, transmit );
+  if ( pacer_ ) { // release what the pacer allows by now
+    pacer_->refill( ms_since_last_tick, pacing_rate(), mss_ );
+    push( transmit );
+  }
+}
+
+void TCPSender::retransmit_on_timeout( uint64_t const ms_since_last_tick, TransmitFunction const& transmit )
+{
+  if ( scoreboard_.empty() ) { return; }
   if ( not timer_.tick( ms_since_last_tick ).is_expired() ) { return; }
 
-  transmit( outstanding_message_.front() );
+  auto& front { scoreboard_.begin()->second };
+  stamp( front.message );
+  transmit( front.message );
+  front.retransmitted = true;
+  rtt_probe_.reset(); // Karn's rule: a retransmitted segment's ACK is ambiguous
   if ( window_size_ != 0 ) {
     total_retransmission_ += 1;
-    timer_.exponential_backoff();
+    timer_.exponential_backoff( rtt_ ? rtt_->max_RTO_ms() : UINT64_MAX );
+    if ( congestion_control_ ) { congestion_control_->on_rto( total_outstanding_, now_ms_ ); }
+    // A timeout ends fast recovery, and the duplicate ACKs of what was in flight mustn't start another one.
+    in_recovery_ = false;
+    dup_acks_ = recovery_inflation_ = 0;
+    lost_.clear();
+    recover_ = next_abs_seqno_;
   }
   timer_.reset();
 }
+
+void TCPSender::on_duplicate_ack()
+{
+  dup_acks_ += 1;
+  if ( in_recovery_ ) {
+    recovery_inflation_ += mss_; // another segment has left the network
+    return;
+  }
+  if ( dup_acks_ == TCPConfig::DUP_ACK_THRESHOLD and ack_abs_seqno_ >= recover_ ) { enter_recovery(); }
+}
+
+void TCPSender::enter_recovery()
+{
+  in_recovery_ = true;
+  recover_ = next_abs_seqno_;
+  if ( auto const& front { scoreboard_.begin()->second }; not front.sacked and not front.retransmitted ) {
+    lost_.insert( scoreboard_.begin()->first );
+  }
+  if ( congestion_control_ ) {
+    congestion_control_->on_loss( total_outstanding_, now_ms_ );
+    recovery_inflation_ = TCPConfig::DUP_ACK_THRESHOLD * mss_;
+  }
+}
+
+void TCPSender::on_recovery_ack( uint64_t const bytes_acked )
+{
+  if ( ack_abs_seqno_ >= recover_ ) { // full ACK: everything outstanding at the loss has arrived
+    in_recovery_ = false;
+    recovery_inflation_ = 0;
+    return;
+  }
+
+  // partial ACK: the segment now at the front was lost as well
+  if ( auto const& front { scoreboard_.begin()->second }; not front.sacked and not front.retransmitted ) {
+    lost_.insert( scoreboard_.begin()->first );
+  }
+  recovery_inflation_ -= std::min( recovery_inflation_, bytes_acked );
+  recovery_inflation_ += mss_;
+}
+
+void TCPSender::apply_sack( const std::vector<SACKBlock>& blocks )
+{
+  for ( auto const& [left, right] : blocks ) {
+    uint64_t const first { left.unwrap( isn_, next_abs_seqno_ ) };
+    uint64_t const last { right.unwrap( isn_, next_abs_seqno_ ) };
+    if ( first >= last or last > next_abs_seqno_ ) { continue; } // not a block of what we sent
+
+    // only segments that the block covers entirely
+    for ( auto it { scoreboard_.lower_bound( first ) };
+          it != scoreboard_.end() and it->first + it->second.message.sequence_length() <= last;
+          ++it ) {
+      if ( not it->second.sacked ) {
+        it->second.sacked = true;
+        sacked_.insert( it->first );
+        lost_.erase( it->first );
+      }
+    }
+  }
+}
+
+void TCPSender::mark_lost()
+{
+  // IsLost(): a segment with DupThresh SACKed segments above it
+  if ( sacked_.size() < TCPConfig::DUP_ACK_THRESHOLD ) { return; }
+  uint64_t const threshold { *std::prev( sacked_.end(), TCPConfig::DUP_ACK_THRESHOLD ) };
+  if ( threshold <= loss_scan_ ) { return; }
+
+  auto const end { scoreboard_.lower_bound( threshold ) };
+  for ( auto it { scoreboard_.lower_bound( loss_scan_ ) }; it != end; ++it ) {
+    if ( not it->second.sacked and not it->second.retransmitted ) { lost_.insert( it->first ); }
+  }
+  loss_scan_ = std::max( loss_scan_, threshold );
+}
+
+uint64_t TCPSender::trim_front( uint64_t const recv_ack_abs_seqno )
+{
+  auto node { scoreboard_.extract( scoreboard_.begin() ) };
+  auto& message { node.mapped().message };
+  uint64_t const acked { recv_ack_abs_seqno - ack_abs_seqno_ };
+  uint64_t const bytes { acked - message.SYN };
+  message.seqno = message.seqno + static_cast<uint32_t>( acked );
+  message.SYN = false;
+  message.payload.remove_prefix( bytes );
+
+  if ( sacked_.erase( node.key() ) ) { sacked_.insert( recv_ack_abs_seqno ); }
+  if ( lost_.erase( node.key() ) ) { lost_.insert( recv_ack_abs_seqno ); }
+  node.key() = recv_ack_abs_seqno;
+  scoreboard_.insert( std::move( node ) );
+
+  ack_abs_seqno_ = recv_ack_abs_seqno;
+  total_outstanding_ -= acked;
+  return bytes;
+}
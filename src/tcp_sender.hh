@@ -1,14 +1,22 @@
 #pragma once
 
 #include "byte_stream.hh"
+#include "congestion_control.hh"
+#include "tcp_config.hh"
 #include "tcp_receiver_message.hh"
 #include "tcp_sender_message.hh"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <functional>
 #include <list>
+#include <map>
 #include <memory>
-#include <queue>
+#include <optional>
+#include <set>
+#include <utility>
+#include <vector>
 
 #define REM [[nodiscard]]
 
@@ -18,8 +26,12 @@ struct RetransmissionTimer
   explicit RetransmissionTimer( uint64_t const initial_RTO_ms ) : RTO_ms_ { initial_RTO_ms } {}
   REM constexpr auto is_active() const noexcept -> bool { return is_active_; }
   REM constexpr auto is_expired() const noexcept -> bool { return is_active_ and timer_ >= RTO_ms_; }
+  REM constexpr auto RTO_ms() const noexcept -> uint64_t { return RTO_ms_; }
   /// 指数回退
-  constexpr void exponential_backoff() noexcept { RTO_ms_ *= 2; }
+  constexpr void exponential_backoff( uint64_t const max_RTO_ms = UINT64_MAX ) noexcept
+  {
+    RTO_ms_ = std::min( RTO_ms_ * 2, max_RTO_ms );
+  }
   constexpr void reload( uint64_t const initial_RTO_ms ) noexcept { RTO_ms_ = initial_RTO_ms, reset(); };
   constexpr void reset() noexcept { timer_ = 0; }
   constexpr void start() noexcept { is_active_ = true, reset(); }
@@ -37,6 +49,78 @@ private:
   uint64_t timer_ {};
 };
 
+struct RTTEstimator
+{
+  /// RFC 6298 往返时间估计
+  RTTEstimator( uint64_t const min_RTO_ms, uint64_t const max_RTO_ms )
+    : min_RTO_ms_ { min_RTO_ms }, max_RTO_ms_ { max_RTO_ms }
+  {}
+  REM constexpr auto has_sample() const noexcept -> bool { return has_sample_; }
+  REM constexpr auto srtt_ms() const noexcept -> double { return srtt_ms_; }
+  REM constexpr auto max_RTO_ms() const noexcept -> uint64_t { return max_RTO_ms_; }
+
+  /// RTO = SRTT + max(G, 4 * RTTVAR), clamped to [min, max]
+  REM auto RTO_ms() const noexcept -> uint64_t
+  {
+    double const rto { srtt_ms_ + std::max( CLOCK_GRANULARITY_ms, 4 * rttvar_ms_ ) };
+    return std::clamp( static_cast<uint64_t>( std::ceil( rto ) ), min_RTO_ms_, max_RTO_ms_ );
+  }
+
+  constexpr void sample( uint64_t const rtt_ms ) noexcept
+  {
+    auto const r { static_cast<double>( rtt_ms ) };
+    if ( not has_sample_ ) {
+      srtt_ms_ = r, rttvar_ms_ = r / 2, has_sample_ = true;
+      return;
+    }
+    rttvar_ms_ = 0.75 * rttvar_ms_ + 0.25 * ( srtt_ms_ > r ? srtt_ms_ - r : r - srtt_ms_ );
+    srtt_ms_ = 0.875 * srtt_ms_ + 0.125 * r;
+  }
+
+private:
+  static constexpr double CLOCK_GRANULARITY_ms = 1; // tick() reports whole milliseconds
+
+  uint64_t min_RTO_ms_;
+  uint64_t max_RTO_ms_;
+  bool has_sample_ {};
+  double srtt_ms_ {};
+  double rttvar_ms_ {};
+};
+
+struct Pacer
+{
+  /// 发送节奏控制（令牌桶）：余额非负时才可发送
+  static constexpr double GAIN_SLOW_START = 2.0; // pace faster than cwnd / SRTT, so that cwnd can grow
+  static constexpr double GAIN = 1.2;
+
+  REM constexpr auto may_send() const noexcept -> bool { return tokens_ >= 0; }
+  constexpr void consume( uint64_t const bytes ) noexcept { tokens_ -= static_cast<double>( bytes ); }
+
+  /// 按速率补充余额，最多积累一个段或 1 ms 的量（空闲之后至多连发两个段）
+  constexpr void refill( uint64_t const ms, double const bytes_per_ms, uint64_t const mss ) noexcept
+  {
+    double const burst { std::max( static_cast<double>( mss ), bytes_per_ms ) };
+    tokens_ = std::min( tokens_ + static_cast<double>( ms ) * bytes_per_ms, burst );
+  }
+
+  /// 距离可以再次发送的毫秒数
+  REM auto wait_ms( double const bytes_per_ms ) const noexcept -> uint64_t
+  {
+    return may_send() ? 0 : static_cast<uint64_t>( std::ceil( -tokens_ / bytes_per_ms ) );
+  }
+
+private:
+  double tokens_ {};
+};
+
+struct OutstandingSegment
+{
+  /// 记分板中尚未确认的段
+  TCPSenderMessage message;
+  bool sacked {};        // covered by one of the receiver's SACK blocks
+  bool retransmitted {}; // resent at least once
+};
+
 class TCPSender
 {
 public:
@@ -45,6 +129,27 @@ public:
     : input_ { std::move( input ) }, isn_ { isn }, initial_RTO_ms_ { initial_RTO_ms }, timer_ { initial_RTO_ms }
   {}
 
+  /* Construct TCP sender with the ISN, Retransmission Timeout and congestion control from a TCPConfig */
+  TCPSender( ByteStream&& input, TCPConfig const& config )
+    : TCPSender( std::move( input ), config.isn, config.rt_timeout )
+  {
+    mss_ = config.mss;
+    super_segments_ = config.super_segments;
+    congestion_control_ = CongestionControl::make( config.congestion, mss_ );
+    if ( config.adaptive_rto ) { rtt_.emplace( config.min_RTO_ms, config.max_RTO_ms ); }
+    fast_retransmit_ = config.fast_retransmit;
+    timestamps_ = config.timestamps;
+    if ( config.pacing ) { pacer_.emplace(); }
+    pacing_rate_ = config.pacing_rate;
+    nagle_ = config.nagle;
+  }
+
+  /* The peer's SYN carried an MSS option: send no more than that in a segment */
+  void set_peer_mss( uint16_t peer_mss );
+
+  /* Whether the handshake settled on timestamps (if not, RTTs are sampled once per window instead) */
+  void set_timestamps( bool timestamps ) { timestamps_ = timestamps; }
+
   /* Generate an empty TCPSenderMessage */
   REM TCPSenderMessage make_empty_message() const;
 
@@ -57,32 +162,93 @@ public:
   /* Push bytes from the outbound stream */
   void push( const TransmitFunction& transmit );
 
+  /* Cork: send only full-sized segments (and the FIN) until uncorked, so that small writes are batched */
+  void cork() { corked_ = true; }
+  void uncork( const TransmitFunction& transmit );
+
   /* Time has passed by the given # of milliseconds since the last time the tick() method was called */
   void tick( uint64_t ms_since_last_tick, const TransmitFunction& transmit );
 
   // Accessors
   REM uint64_t sequence_numbers_in_flight() const;  // How many sequence numbers are outstanding?
   REM uint64_t consecutive_retransmissions() const; // How many consecutive *re*transmissions have happened?
+  REM const CongestionControl* congestion_control() const { return congestion_control_.get(); } // (null if none)
+  REM std::optional<double> srtt_ms() const; // Smoothed RTT (adaptive RTO only, once there is a sample)
+  REM uint64_t RTO_ms() const { return timer_.RTO_ms(); } // Current retransmission timeout, including backoff
+  REM uint64_t fast_retransmissions() const { return fast_retransmissions_; } // Segments resent without a timeout
+  REM bool in_fast_recovery() const { return in_recovery_; }
+  REM std::optional<uint64_t> next_transmit_ms() const; // With pacing: how long until the next segment may go
+  REM bool corked() const { return corked_; }
+  REM uint64_t mss() const { return mss_; }
+  REM uint64_t max_payload_size() const { return super_segments_ ? TCPConfig::MAX_SUPER_SEGMENT : mss_; }
   Writer& writer() { return input_.writer(); }
   REM const Writer& writer() const { return input_.writer(); }
   // Access input stream reader, but const-only (can't read from outside)
   REM const Reader& reader() const { return input_.reader(); }
 
 private:
+  /// How many sequence numbers may be outstanding: min(cwnd, receiver's window), and at least 1
+  REM uint64_t send_window() const;
+  /// The RTO to restart the timer with after new data is acknowledged
+  REM uint64_t base_RTO_ms() const;
+  /// RFC 5681 fast retransmit on the third duplicate ACK, then NewReno (RFC 6582) fast recovery
+  void on_duplicate_ack();
+  void on_recovery_ack( uint64_t bytes_acked );
+  void enter_recovery();
+  /// RFC 6675: mark the segments the receiver's SACK blocks cover, then those they show to be lost
+  void apply_sack( const std::vector<SACKBlock>& blocks );
+  void mark_lost();
+  /// Super-segments: drop the acknowledged part of the segment at the front, returning its payload bytes
+  uint64_t trim_front( uint64_t recv_ack_abs_seqno );
+  /// Timestamps: set TSval to the current time, just before (re)transmitting
+  void stamp( TCPSenderMessage& message ) const;
+  /// Pacing: bytes per ms, or 0 for no pacing (yet)
+  REM double pacing_rate() const;
+  /// Is there anything push() would send if the windows and the pacer allowed?
+  REM bool has_new_data() const;
+  /// Nagle or cork: keep a short segment back for now?
+  REM bool hold_short_segment() const;
+  void retransmit_on_timeout( uint64_t ms_since_last_tick, const TransmitFunction& transmit );
+
   // Variables initialized in constructor
   ByteStream input_;
   Wrap32 isn_;
   uint64_t initial_RTO_ms_;
 
   RetransmissionTimer timer_;
+  uint64_t mss_ { TCPConfig::MAX_PAYLOAD_SIZE };
+  bool super_segments_ {}; // one message may carry up to MAX_SUPER_SEGMENT bytes, for the adapter to split
+  std::unique_ptr<CongestionControl> congestion_control_ {};
+  uint64_t now_ms_ {}; // total of the ms passed to tick()
+
+  std::optional<RTTEstimator> rtt_ {}; // (adaptive RTO only)
+  // The segment being timed: the absolute seqno that acknowledges it, and when it was sent
+  std::optional<std::pair<uint64_t, uint64_t>> rtt_probe_ {};
+  bool timestamps_ {}; // every segment carries TSval, and every ACK of new data gives an RTT sample
+
+  std::optional<Pacer> pacer_ {}; // (pacing only)
+  uint64_t pacing_rate_ {};       // configured, in bytes/s (0: from cwnd / SRTT)
+
+  bool nagle_ {};  // no short segment while any data is unacknowledged
+  bool corked_ {}; // no short segment at all
+
+  bool fast_retransmit_ {};
+  uint64_t dup_acks_ {};
+  bool in_recovery_ {};
+  uint64_t recover_ {};            // next_abs_seqno_ when recovery began; an ACK reaching it ends recovery
+  uint64_t recovery_inflation_ {}; // bytes the window is inflated by during fast recovery
+  uint64_t fast_retransmissions_ {};
 
   bool SYN_sent_ {};
   bool FIN_sent_ {};
 
   uint64_t next_abs_seqno_ {};
   uint64_t ack_abs_seqno_ {};
-  uint16_t window_size_ { 1 };
-  std::queue<TCPSenderMessage> outstanding_message_ {};
+  uint32_t window_size_ { 1 };
+  std::map<uint64_t, OutstandingSegment> scoreboard_ {}; // outstanding segments, by absolute seqno
+  std::set<uint64_t> sacked_ {};                        // seqnos of the SACKed segments in the scoreboard
+  std::set<uint64_t> lost_ {};                          // seqnos of lost segments for push() to resend
+  uint64_t loss_scan_ {};                               // mark_lost() has already looked below this seqno
 
   uint64_t total_outstanding_ {};
   uint64_t total_retransmission_ {};
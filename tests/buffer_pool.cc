@@ -0,0 +1,77 @@
+#include "buffer_pool.hh"
+#include "byte_stream.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    BufferPool pool;
+
+    // an empty pool allocates, with capacity rounded up to the size class
+    string a = pool.acquire( 1000 );
+    test_should_be( a.empty(), true );
+    test_should_be( a.capacity() >= 1024, true );
+    test_should_be( pool.stats().misses, uint64_t { 1 } );
+
+    // a released allocation is handed out again for any request in its class
+    a.assign( 1000, 'x' );
+    const char* const allocation = a.data();
+    pool.release( move( a ) );
+    test_should_be( a.empty(), true );
+    test_should_be( pool.stats().recycled, uint64_t { 1 } );
+    test_should_be( pool.stats().cached_bytes >= 1024, true );
+
+    string b = pool.acquire( 600 );
+    test_should_be( b.data() == allocation, true );
+    test_should_be( b.empty(), true );
+    test_should_be( pool.stats().hits, uint64_t { 1 } );
+    test_should_be( pool.stats().cached_bytes, uint64_t { 0 } );
+
+    // a request for the next class up can't use it
+    pool.release( move( b ) );
+    const string c = pool.acquire( 1025 );
+    test_should_be( c.data() == allocation, false );
+    test_should_be( pool.stats().misses, uint64_t { 2 } );
+    test_should_be( pool.stats().hit_rate() > 0.3 and pool.stats().hit_rate() < 0.4, true );
+
+    // short strings and huge strings are not kept
+    pool.release( string { "short" } );
+    pool.release( string( size_t { 1 } << 20, 'y' ) );
+    test_should_be( pool.stats().recycled, uint64_t { 2 } );
+    test_should_be( pool.stats().discarded, uint64_t { 1 } );
+
+    // each free list is bounded
+    for ( size_t i = 0; i < BufferPool::MAX_FREE_PER_CLASS + 10; ++i ) {
+      pool.release( string( 100, 'z' ) );
+    }
+    test_should_be( pool.stats().discarded, uint64_t { 11 } );
+    const uint64_t high_water = pool.stats().high_water_bytes;
+    test_should_be( high_water >= BufferPool::MAX_FREE_PER_CLASS * 64, true );
+
+    pool.trim();
+    test_should_be( pool.stats().cached_bytes, uint64_t { 0 } );
+    test_should_be( pool.stats().high_water_bytes, high_water );
+
+    // chunks popped from a ByteStream go back to the calling thread's pool
+    const uint64_t recycled_before = BufferPool::local().stats().recycled;
+    ByteStream stream { 4096 };
+    stream.writer().push( string( 2000, 'a' ) );
+    stream.writer().push( string( 2000, 'b' ) );
+    stream.reader().pop( 2500 );
+    test_should_be( BufferPool::local().stats().recycled, recycled_before + 1 );
+    stream.reader().pop( 1500 );
+    test_should_be( BufferPool::local().stats().recycled, recycled_before + 2 );
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,66 @@
+#include "byte_stream_test_harness.hh"
+#include "exception.hh"
+
+#include <array>
+#include <exception>
+#include <fcntl.h>
+#include <iostream>
+#include <unistd.h>
+
+using namespace std;
+
+void push_from_test( const ByteStream::Storage storage )
+{
+  array<int, 2> fds {};
+  CheckSystemCall( "pipe2", ::pipe2( fds.data(), O_NONBLOCK ) );
+  FileDescriptor read_end { fds[0] };
+  FileDescriptor write_end { fds[1] };
+
+  ByteStreamTestHarness test { "push_from a pipe", 8, storage };
+
+  // nothing to read yet
+  test.execute( PushFrom { read_end, 0 } );
+  test.execute( BytesBuffered { 0 } );
+
+  write_end.write( "hello" );
+  test.execute( PushFrom { read_end, 5 } );
+  test.execute( BytesPushed { 5 } );
+  test.execute( Peek { "hello" } );
+
+  // only as much as the stream has room for
+  write_end.write( "abcdefgh" );
+  test.execute( PushFrom { read_end, 3 } );
+  test.execute( AvailableCapacity { 0 } );
+  test.execute( PushFrom { read_end, 0 } );
+  test.execute( PeekAll { "helloabc" } );
+
+  // the rest of the pipe's contents fill the space freed by pop (wrapping around the end of a ring)
+  test.execute( Pop { 6 } );
+  test.execute( PushFrom { read_end, 5 } );
+  test.execute( BytesPushed { 13 } );
+  test.execute( PeekAll { "bcdefgh" } );
+  test.execute( Peek { "bcdefgh" } );
+
+  write_end.close();
+  test.execute( PushFrom { read_end, 0 } );
+  if ( not read_end.eof() ) {
+    throw runtime_error( "push_from() did not report EOF on the file descriptor" );
+  }
+
+  // a closed stream doesn't read
+  test.execute( Close {} );
+  test.execute( PushFrom { read_end, 0 } );
+}
+
+int main()
+{
+  try {
+    push_from_test( ByteStream::Storage::Chunked );
+    push_from_test( ByteStream::Storage::Ring );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
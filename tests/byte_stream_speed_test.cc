@@ -15,7 +15,8 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
                  const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
                  const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
                  const size_t write_size,  // NOLINT(bugprone-easily-swappable-parameters)
-                 const size_t read_size )  // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t read_size,   // NOLINT(bugprone-easily-swappable-parameters)
+                 const ByteStream::Storage storage )
 {
   // Generate the data to be written
   const string data = [&random_seed, &input_len] {
@@ -34,7 +35,7 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
     split_data.emplace( data.substr( i, write_size ) );
   }
 
-  ByteStream bs { capacity };
+  ByteStream bs { capacity, storage };
   string output_data;
   output_data.reserve( data.size() );
 
@@ -75,11 +76,14 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
   fstream debug_output;
   debug_output.open( "/dev/tty" );
 
-  cout << "ByteStream with capacity=" << capacity << ", write_size=" << write_size << ", read_size=" << read_size
-       << " reached " << fixed << setprecision( 2 ) << gigabits_per_second << " Gbit/s.\n";
+  const string_view storage_name = storage == ByteStream::Storage::Ring ? "ring" : "chunked";
 
-  debug_output << "             ByteStream throughput: " << fixed << setprecision( 2 ) << gigabits_per_second
-               << " Gbit/s\n";
+  cout << "ByteStream (" << storage_name << ") with capacity=" << capacity << ", write_size=" << write_size
+       << ", read_size=" << read_size << " reached " << fixed << setprecision( 2 ) << gigabits_per_second
+       << " Gbit/s.\n";
+
+  debug_output << "             ByteStream (" << storage_name << ", write=" << write_size << ", read=" << read_size
+               << ") throughput: " << fixed << setprecision( 2 ) << gigabits_per_second << " Gbit/s\n";
 
   if ( gigabits_per_second < 0.1 ) {
     throw runtime_error( "ByteStream did not meet minimum speed of 0.1 Gbit/s." );
@@ -88,7 +92,12 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
 
 void program_body()
 {
-  speed_test( 1e7, 32768, 789, 1500, 128 );
+  for ( const auto storage : { ByteStream::Storage::Chunked, ByteStream::Storage::Ring } ) {
+    speed_test( 1e7, 32768, 789, 1500, 128, storage );
+    speed_test( 1e7, 32768, 789, 16, 4096, storage );
+    speed_test( 1e7, 32768, 789, 128, 128, storage );
+    speed_test( 1e7, 32768, 789, 8192, 8192, storage );
+  }
 }
 
 int main()
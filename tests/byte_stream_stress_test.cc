@@ -5,9 +5,10 @@
 
 using namespace std;
 
-void stress_test( const size_t input_len,    // NOLINT(bugprone-easily-swappable-parameters)
-                  const size_t capacity,     // NOLINT(bugprone-easily-swappable-parameters)
-                  const size_t random_seed ) // NOLINT(bugprone-easily-swappable-parameters)
+void stress_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-parameters)
+                  const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
+                  const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
+                  const ByteStream::Storage storage )
 {
   default_random_engine rd { random_seed };
 
@@ -21,7 +22,8 @@ void stress_test( const size_t input_len,    // NOLINT(bugprone-easily-swappable
   }();
 
   ByteStreamTestHarness bs { "stress test input=" + to_string( input_len ) + ", capacity=" + to_string( capacity ),
-                             capacity };
+                             capacity,
+                             storage };
 
   size_t expected_bytes_pushed {};
   size_t expected_bytes_popped {};
@@ -56,6 +58,7 @@ void stress_test( const size_t input_len,    // NOLINT(bugprone-easily-swappable
     }
 
     bs.execute( PeekOnce { data.substr( expected_bytes_popped, peek_size ) } );
+    bs.execute( PeekAll { data.substr( expected_bytes_popped, expected_bytes_pushed - expected_bytes_popped ) } );
 
     uniform_int_distribution<size_t> bytes_to_pop_dist { 0, peek_size };
     const size_t amount_to_pop = bytes_to_pop_dist( rd );
@@ -72,10 +75,12 @@ void stress_test( const size_t input_len,    // NOLINT(bugprone-easily-swappable
 
 void program_body()
 {
-  stress_test( 19, 3, 10110 );
-  stress_test( 18, 17, 12345 );
-  stress_test( 1111, 17, 98765 );
-  stress_test( 4097, 4096, 11101 );
+  for ( const auto storage : { ByteStream::Storage::Chunked, ByteStream::Storage::Ring } ) {
+    stress_test( 19, 3, 10110, storage );
+    stress_test( 18, 17, 12345, storage );
+    stress_test( 1111, 17, 98765, storage );
+    stress_test( 4097, 4096, 11101, storage );
+  }
 }
 
 int main()
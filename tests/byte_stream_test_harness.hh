@@ -2,6 +2,7 @@
 
 #include "byte_stream.hh"
 #include "common.hh"
+#include "file_descriptor.hh"
 
 #include <concepts>
 #include <optional>
@@ -16,8 +17,13 @@ static_assert( sizeof( Writer ) == sizeof( ByteStream ),
 class ByteStreamTestHarness : public TestHarness<ByteStream>
 {
 public:
-  ByteStreamTestHarness( std::string test_name, uint64_t capacity )
-    : TestHarness( move( test_name ), "capacity=" + std::to_string( capacity ), ByteStream { capacity } )
+  ByteStreamTestHarness( std::string test_name,
+                         uint64_t capacity,
+                         ByteStream::Storage storage = ByteStream::Storage::Chunked )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( capacity )
+                     + ( storage == ByteStream::Storage::Ring ? ", storage=ring" : "" ),
+                   ByteStream { capacity, storage } )
   {}
 
   size_t peek_size() { return object().reader().peek().size(); }
@@ -34,6 +40,25 @@ struct Push : public Action<ByteStream>
   void execute( ByteStream& bs ) const override { bs.writer().push( data_ ); }
 };
 
+struct PushFrom : public Action<ByteStream>
+{
+  FileDescriptor& fd_;
+  uint64_t expected_;
+
+  PushFrom( FileDescriptor& fd, uint64_t expected ) : fd_( fd ), expected_( expected ) {}
+  std::string description() const override
+  {
+    return "push_from( fd ) pushes " + std::to_string( expected_ ) + " bytes";
+  }
+  void execute( ByteStream& bs ) const override
+  {
+    const uint64_t pushed = bs.writer().push_from( fd_ );
+    if ( pushed != expected_ ) {
+      throw ExpectationViolation { "push_from", expected_, pushed };
+    }
+  }
+};
+
 struct Close : public Action<ByteStream>
 {
   std::string description() const override { return "close"; }
@@ -107,6 +132,31 @@ struct PeekOnce : public Peek
   }
 };
 
+struct PeekAll : public Peek
+{
+  using Peek::Peek;
+
+  std::string description() const override
+  {
+    return "peek_all() gives exactly \"" + Printer::prettify( output_ ) + "\"";
+  }
+
+  void execute( ByteStream& bs ) const override
+  {
+    std::string got;
+    for ( const auto view : bs.reader().peek_all() ) {
+      if ( view.empty() ) {
+        throw ExpectationViolation { "Reader::peek_all() returned an empty string_view" };
+      }
+      got += view;
+    }
+    if ( got != output_ ) {
+      throw ExpectationViolation { "Expected exactly \"" + Printer::prettify( output_ ) + "\" buffered, "
+                                   + "but peek_all() found \"" + Printer::prettify( got ) + "\"" };
+    }
+  }
+};
+
 struct IsClosed : public ConstExpectBool<ByteStream>
 {
   using ConstExpectBool::ConstExpectBool;
@@ -0,0 +1,135 @@
+#include "checksum.hh"
+#include "ipv4_header.hh"
+#include "random.hh"
+#include "tcp_segment.hh"
+#include "test_should_be.hh"
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+namespace {
+using Kernel = InternetChecksum::Kernel;
+constexpr array kernels { Kernel::Word64, Kernel::SSE2, Kernel::AVX2 };
+
+// The checksum of `data` split into `pieces`, with the given kernel
+uint16_t checksum( uint32_t initial, const vector<string_view>& pieces, Kernel kernel )
+{
+  InternetChecksum check { initial };
+  for ( const auto piece : pieces ) {
+    check.add( piece, kernel );
+  }
+  return check.value();
+}
+} // namespace
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      // RFC 1071 section 3's example: the words 0001 f203 f4f5 f6f7 sum to ddf2
+      const string data { "\x00\x01\xf2\x03\xf4\xf5\xf6\xf7", 8 };
+      for ( const auto kernel : { Kernel::Scalar, Kernel::Word64, Kernel::SSE2, Kernel::AVX2 } ) {
+        if ( InternetChecksum::supported( kernel ) ) {
+          test_should_be( checksum( 0, { data }, kernel ), uint16_t { 0x220d } );
+        }
+      }
+      InternetChecksum check;
+      check.add( data );
+      test_should_be( check.value(), uint16_t { 0x220d } );
+    }
+
+    {
+      // all ones: the sum must wrap around many times
+      const string data( 100000, '\xff' );
+      for ( const auto kernel : kernels ) {
+        if ( InternetChecksum::supported( kernel ) ) {
+          test_should_be( checksum( 0xffff, { data }, kernel ), checksum( 0xffff, { data }, Kernel::Scalar ) );
+        }
+      }
+    }
+
+    // random data, split at random (often odd) boundaries
+    for ( unsigned trial = 0; trial < 2000; ++trial ) {
+      string data( rd() % 3000, 0 );
+      for ( auto& c : data ) {
+        c = static_cast<char>( rd() );
+      }
+      vector<string_view> pieces;
+      string_view rest { data };
+      while ( not rest.empty() ) {
+        const size_t len = rd() % 4 == 0 ? rd() % 4 : rd() % 300; // including empty and one-byte pieces
+        pieces.push_back( rest.substr( 0, len ) );
+        rest.remove_prefix( pieces.back().size() );
+      }
+
+      const uint32_t initial = rd() % 0x40000;
+      const uint16_t expected = checksum( initial, pieces, Kernel::Scalar );
+      for ( const auto kernel : kernels ) {
+        if ( InternetChecksum::supported( kernel ) ) {
+          test_should_be( checksum( initial, pieces, kernel ), expected );
+        }
+      }
+
+      InternetChecksum check { initial };
+      check.add( pieces );
+      test_should_be( check.value(), expected );
+    }
+
+    // RFC 1624: forwarding decrements the TTL without summing the header again
+    for ( unsigned trial = 0; trial < 200; ++trial ) {
+      IPv4Header header;
+      header.ttl = static_cast<uint8_t>( rd() );
+      header.proto = static_cast<uint8_t>( rd() );
+      header.len = static_cast<uint16_t>( rd() );
+      header.id = static_cast<uint16_t>( rd() );
+      header.src = rd();
+      header.dst = rd();
+      header.compute_checksum();
+      while ( header.ttl > 0 ) {
+        header.decrement_ttl();
+        IPv4Header recomputed = header;
+        recomputed.compute_checksum();
+        test_should_be( header.cksum, recomputed.cksum );
+      }
+    }
+
+    // and a NAT rewrites an address (in the TCP pseudo-header) and a port the same way
+    for ( unsigned trial = 0; trial < 200; ++trial ) {
+      IPv4Header header;
+      header.src = rd();
+      header.dst = rd();
+      TCPSegment seg;
+      seg.udinfo.src_port = static_cast<uint16_t>( rd() );
+      seg.udinfo.dst_port = static_cast<uint16_t>( rd() );
+      seg.message.sender.seqno = Wrap32 { static_cast<uint32_t>( rd() ) };
+      seg.message.sender.payload = string( rd() % 1500, static_cast<char>( rd() ) );
+      const size_t tcp_length = seg.header_length() + seg.message.sender.payload.size();
+      header.len = static_cast<uint16_t>( IPv4Header::LENGTH + tcp_length );
+      seg.compute_checksum( header.pseudo_checksum() );
+
+      const uint32_t new_src = rd();
+      const auto new_port = static_cast<uint16_t>( rd() );
+      uint16_t cksum = InternetChecksum::update32( seg.udinfo.cksum, header.src, new_src );
+      cksum = InternetChecksum::update16( cksum, seg.udinfo.src_port, new_port );
+      header.src = new_src;
+      seg.udinfo.src_port = new_port;
+      seg.compute_checksum( header.pseudo_checksum() );
+      test_should_be( cksum, seg.udinfo.cksum );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,115 @@
+#include "checksum.hh"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+using namespace std;
+using namespace std::chrono;
+
+// Throughput of each InternetChecksum kernel, over segment-sized and large chunks.
+
+namespace {
+
+using Kernel = InternetChecksum::Kernel;
+
+string_view name( Kernel kernel )
+{
+  switch ( kernel ) {
+    case Kernel::Scalar:
+      return "scalar";
+    case Kernel::Word64:
+      return "64-bit words";
+    case Kernel::SSE2:
+      return "SSE2";
+    case Kernel::AVX2:
+      return "AVX2";
+  }
+  return "?";
+}
+
+string make_data( size_t len, size_t random_seed )
+{
+  default_random_engine rd { random_seed };
+  uniform_int_distribution<char> ud;
+  string ret;
+  for ( size_t i = 0; i < len; ++i ) {
+    ret += ud( rd );
+  }
+  return ret;
+}
+
+// Gbit/s to checksum `total` bytes, `chunk_size` at a time
+double speed( Kernel kernel, const string& data, size_t chunk_size, size_t total, uint16_t& result )
+{
+  const auto start_time = steady_clock::now();
+  uint32_t sum = 0;
+  for ( size_t done = 0; done < total; done += data.size() ) {
+    InternetChecksum check;
+    for ( size_t i = 0; i < data.size(); i += chunk_size ) {
+      check.add( string_view { data }.substr( i, chunk_size ), kernel );
+    }
+    sum += check.value();
+  }
+  result = static_cast<uint16_t>( sum );
+  const auto seconds = duration_cast<duration<double>>( steady_clock::now() - start_time ).count();
+  return 8 * static_cast<double>( total ) / seconds / 1e9;
+}
+
+void speed_test( const size_t data_len, const size_t chunk_size, const size_t total )
+{
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  const string data = make_data( data_len, 1071 );
+  uint16_t expected {};
+  double scalar_speed {};
+  for ( const auto kernel : { Kernel::Scalar, Kernel::Word64, Kernel::SSE2, Kernel::AVX2 } ) {
+    if ( not InternetChecksum::supported( kernel ) ) {
+      continue;
+    }
+    uint16_t result {};
+    const double gigabits_per_second = speed( kernel, data, chunk_size, total, result );
+    if ( kernel == Kernel::Scalar ) {
+      expected = result;
+      scalar_speed = gigabits_per_second;
+    } else if ( result != expected ) {
+      throw runtime_error( "InternetChecksum kernels disagree" );
+    }
+
+    cout << "InternetChecksum (" << name( kernel ) << ", " << data_len << " bytes in chunks of " << chunk_size
+         << "): " << fixed << setprecision( 2 ) << gigabits_per_second << " Gbit/s ("
+         << gigabits_per_second / scalar_speed << "x scalar).\n";
+    debug_output << "             " << name( kernel ) << " (" << data_len << "/" << chunk_size << "): " << fixed
+                 << setprecision( 2 ) << gigabits_per_second << " Gbit/s\n";
+  }
+}
+
+} // namespace
+
+void program_body()
+{
+  speed_test( 1500, 1500, 5e8 ); // a segment at a time
+  speed_test( 65536, 1000, 5e8 );
+  speed_test( 65536, 999, 5e8 ); // odd chunks
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
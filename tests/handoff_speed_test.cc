@@ -0,0 +1,247 @@
+#include "exception.hh"
+#include "file_descriptor.hh"
+#include "spsc_byte_stream.hh"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <poll.h>
+#include <random>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace std;
+using namespace std::chrono;
+
+// Compares the two ways TCPMinnowSocket can hand bytes between the owner thread and the TCPPeer thread:
+// an AF_UNIX socketpair, and a pair of SPSCByteStreams with eventfd doorbells.
+
+namespace {
+
+void wait_for( EventFD& event )
+{
+  pollfd pfd { event.fd_num(), POLLIN, 0 };
+  CheckSystemCall( "poll", ::poll( &pfd, 1, -1 ) );
+  event.clear();
+}
+
+pair<FileDescriptor, FileDescriptor> make_socket_pair()
+{
+  array<int, 2> fds {};
+  CheckSystemCall( "socketpair", ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds.data() ) );
+  return { FileDescriptor { fds[0] }, FileDescriptor { fds[1] } };
+}
+
+string make_data( size_t len, size_t random_seed )
+{
+  default_random_engine rd { random_seed };
+  uniform_int_distribution<char> ud;
+  string ret;
+  for ( size_t i = 0; i < len; ++i ) {
+    ret += ud( rd );
+  }
+  return ret;
+}
+
+void write_all( FileDescriptor& fd, string_view data )
+{
+  while ( not data.empty() ) {
+    data.remove_prefix( fd.write( data ) );
+  }
+}
+
+void read_exactly( FileDescriptor& fd, string& buffer, size_t len )
+{
+  buffer.resize( len );
+  string_view remaining { buffer };
+  while ( not remaining.empty() ) {
+    const ssize_t n = ::read( fd.fd_num(), const_cast<char*>( remaining.data() ), remaining.size() ); // NOLINT
+    if ( n <= 0 ) {
+      throw unix_error { "read" };
+    }
+    remaining.remove_prefix( n );
+  }
+}
+
+void push_all( SPSCByteStream& ring, string_view data )
+{
+  while ( not data.empty() ) {
+    const uint64_t n = ring.push( data );
+    if ( n == 0 ) {
+      wait_for( ring.writable_event() );
+    }
+    data.remove_prefix( n );
+  }
+}
+
+void pop_exactly( SPSCByteStream& ring, string& buffer, size_t len )
+{
+  buffer.clear();
+  while ( buffer.size() < len ) {
+    const auto peeked = ring.peek().substr( 0, len - buffer.size() );
+    if ( peeked.empty() ) {
+      wait_for( ring.readable_event() );
+      continue;
+    }
+    buffer += peeked;
+    ring.pop( peeked.size() );
+  }
+}
+
+void report( string_view path, string_view what, double value, string_view unit )
+{
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << "Owner<->TCPPeer handoff over " << path << ": " << what << " " << fixed << setprecision( 2 ) << value
+       << " " << unit << ".\n";
+  debug_output << "             " << path << " " << what << ": " << fixed << setprecision( 2 ) << value << " "
+               << unit << "\n";
+}
+
+void bulk_test( const size_t input_len, const size_t capacity, const size_t chunk_size )
+{
+  const string data = make_data( input_len, 3141 );
+
+  // socketpair: the producer writes, the consumer reads
+  {
+    auto [producer_end, consumer_end] = make_socket_pair();
+    string received;
+    const auto start_time = steady_clock::now();
+    thread consumer { [&] {
+      string chunk;
+      received.reserve( input_len );
+      while ( received.size() < input_len ) {
+        read_exactly( consumer_end, chunk, min( chunk_size, input_len - received.size() ) );
+        received += chunk;
+      }
+    } };
+    for ( size_t i = 0; i < input_len; i += chunk_size ) {
+      write_all( producer_end, string_view { data }.substr( i, chunk_size ) );
+    }
+    consumer.join();
+    const auto seconds = duration_cast<duration<double>>( steady_clock::now() - start_time ).count();
+    if ( received != data ) {
+      throw runtime_error( "Mismatch between data written and read over the socketpair" );
+    }
+    report( "socketpair",
+            "bulk throughput (chunk=" + to_string( chunk_size ) + ")",
+            8 * static_cast<double>( input_len ) / seconds / 1e9,
+            "Gbit/s" );
+  }
+
+  // shared ring: the producer pushes, the consumer pops
+  {
+    SPSCByteStream ring { capacity };
+    string received;
+    const auto start_time = steady_clock::now();
+    thread consumer { [&] {
+      string chunk;
+      received.reserve( input_len );
+      while ( received.size() < input_len ) {
+        pop_exactly( ring, chunk, min( chunk_size, input_len - received.size() ) );
+        received += chunk;
+      }
+    } };
+    for ( size_t i = 0; i < input_len; i += chunk_size ) {
+      push_all( ring, string_view { data }.substr( i, chunk_size ) );
+    }
+    consumer.join();
+    const auto seconds = duration_cast<duration<double>>( steady_clock::now() - start_time ).count();
+    if ( received != data ) {
+      throw runtime_error( "Mismatch between data pushed and popped through the shared ring" );
+    }
+    const auto gigabits_per_second = 8 * static_cast<double>( input_len ) / seconds / 1e9;
+    report(
+      "shared ring", "bulk throughput (chunk=" + to_string( chunk_size ) + ")", gigabits_per_second, "Gbit/s" );
+    if ( gigabits_per_second < 0.1 ) {
+      throw runtime_error( "SPSCByteStream did not meet minimum speed of 0.1 Gbit/s." );
+    }
+  }
+}
+
+void latency_test( const size_t rounds, const size_t message_size )
+{
+  const string message = make_data( message_size, 2718 );
+
+  // socketpair: echo each message back
+  {
+    auto [near_end, far_end] = make_socket_pair();
+    thread echo { [&, &far = far_end] {
+      string buffer;
+      for ( size_t i = 0; i < rounds; ++i ) {
+        read_exactly( far, buffer, message_size );
+        write_all( far, buffer );
+      }
+    } };
+    string reply;
+    const auto start_time = steady_clock::now();
+    for ( size_t i = 0; i < rounds; ++i ) {
+      write_all( near_end, message );
+      read_exactly( near_end, reply, message_size );
+    }
+    const auto seconds = duration_cast<duration<double>>( steady_clock::now() - start_time ).count();
+    echo.join();
+    if ( reply != message ) {
+      throw runtime_error( "Mismatch between message and echo over the socketpair" );
+    }
+    report( "socketpair",
+            "round trip (message=" + to_string( message_size ) + ")",
+            seconds / static_cast<double>( rounds ) * 1e6,
+            "us" );
+  }
+
+  // shared ring: one ring in each direction
+  {
+    SPSCByteStream there { 65536 };
+    SPSCByteStream back { 65536 };
+    thread echo { [&] {
+      string buffer;
+      for ( size_t i = 0; i < rounds; ++i ) {
+        pop_exactly( there, buffer, message_size );
+        push_all( back, buffer );
+      }
+    } };
+    string reply;
+    const auto start_time = steady_clock::now();
+    for ( size_t i = 0; i < rounds; ++i ) {
+      push_all( there, message );
+      pop_exactly( back, reply, message_size );
+    }
+    const auto seconds = duration_cast<duration<double>>( steady_clock::now() - start_time ).count();
+    echo.join();
+    if ( reply != message ) {
+      throw runtime_error( "Mismatch between message and echo through the shared rings" );
+    }
+    report( "shared ring",
+            "round trip (message=" + to_string( message_size ) + ")",
+            seconds / static_cast<double>( rounds ) * 1e6,
+            "us" );
+  }
+}
+
+} // namespace
+
+void program_body()
+{
+  bulk_test( 1e8, 65536, 16384 );
+  bulk_test( 1e7, 65536, 256 );
+  latency_test( 20000, 64 );
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
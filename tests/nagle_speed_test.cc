@@ -0,0 +1,155 @@
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+using namespace std;
+
+// How many segments a stream of small writes turns into, with and without Nagle (or cork). The two TCPPeers
+// are connected by a simulated link with a fixed one-way delay, so the run takes no real time.
+
+namespace {
+
+constexpr uint64_t ONE_WAY_MS = 10;
+constexpr uint64_t WRITE_SIZE = 50;     // bytes per application write
+constexpr uint64_t WRITES_PER_MS = 8;   // a burst of writes each millisecond...
+constexpr uint64_t DURATION_MS = 2000;  // ... for this long
+constexpr uint64_t TIME_LIMIT_MS = 60000;
+
+enum class Mode : uint8_t
+{
+  Plain,
+  Nagle,
+  Cork // cork before each burst of writes, uncork after it
+};
+
+struct Result
+{
+  uint64_t data_segments {};
+  uint64_t bytes {};
+  uint64_t finish_ms {};
+
+  double segments_per_KB() const
+  {
+    return static_cast<double>( data_segments ) * 1024 / static_cast<double>( bytes );
+  }
+};
+
+using Link = deque<pair<uint64_t, TCPMessage>>; // messages in flight, by arrival time
+
+void deliver( Link& link, uint64_t now, TCPPeer& peer, const TCPPeer::TransmitFunction& transmit )
+{
+  while ( not link.empty() and link.front().first <= now ) {
+    TCPMessage msg = move( link.front().second );
+    link.pop_front();
+    peer.receive( move( msg ), transmit );
+  }
+}
+
+Result run( Mode mode )
+{
+  TCPConfig cfg;
+  cfg.nagle = mode == Mode::Nagle;
+  TCPPeer sender { cfg };
+  TCPPeer receiver { TCPConfig {} };
+
+  Result result;
+  uint64_t now = 0;
+  Link to_receiver;
+  Link to_sender;
+  const auto send_to_receiver = [&]( TCPMessage msg ) {
+    result.data_segments += not msg.sender.payload.empty();
+    to_receiver.emplace_back( now + ONE_WAY_MS, move( msg ) );
+  };
+  const auto send_to_sender = [&]( TCPMessage msg ) { to_sender.emplace_back( now + ONE_WAY_MS, move( msg ) ); };
+
+  const string write( WRITE_SIZE, 'x' );
+  const uint64_t total = WRITE_SIZE * WRITES_PER_MS * DURATION_MS;
+  uint64_t written = 0;
+  uint64_t start_ms = 0;
+
+  sender.push( send_to_receiver ); // SYN
+  while ( receiver.inbound_reader().bytes_popped() < total ) {
+    if ( ++now > TIME_LIMIT_MS ) {
+      throw runtime_error( "stream did not finish in time" );
+    }
+    sender.tick( 1, send_to_receiver );
+    receiver.tick( 1, send_to_sender );
+    deliver( to_receiver, now, receiver, send_to_sender );
+    deliver( to_sender, now, sender, send_to_receiver );
+
+    const bool established = sender.has_ackno();
+    if ( established and written < total ) {
+      start_ms = start_ms ? start_ms : now;
+      if ( mode == Mode::Cork ) {
+        sender.cork();
+      }
+      for ( uint64_t i = 0; i < WRITES_PER_MS and sender.outbound_writer().available_capacity() >= WRITE_SIZE;
+            ++i ) {
+        sender.outbound_writer().push( write );
+        written += WRITE_SIZE;
+        sender.push( send_to_receiver );
+      }
+      if ( mode == Mode::Cork ) {
+        sender.uncork( send_to_receiver );
+      }
+    }
+
+    Reader& inbound = receiver.inbound_reader();
+    inbound.pop( inbound.bytes_buffered() );
+  }
+
+  result.bytes = total;
+  result.finish_ms = now - start_ms;
+  return result;
+}
+
+void report( string_view name, const Result& result )
+{
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << "Small writes (" << WRITE_SIZE << " bytes) " << name << ": " << fixed << setprecision( 2 )
+       << result.segments_per_KB() << " segments per KB, " << result.data_segments << " segments, done in "
+       << result.finish_ms << " ms.\n";
+  debug_output << "             " << name << ": " << fixed << setprecision( 2 ) << result.segments_per_KB()
+               << " segments/KB (" << result.finish_ms << " ms)\n";
+}
+
+} // namespace
+
+void program_body()
+{
+  const Result plain = run( Mode::Plain );
+  const Result nagle = run( Mode::Nagle );
+  const Result cork = run( Mode::Cork );
+  report( "without Nagle", plain );
+  report( "with Nagle", nagle );
+  report( "corked per burst", cork );
+
+  if ( nagle.data_segments >= plain.data_segments or cork.data_segments >= plain.data_segments ) {
+    throw runtime_error( "Nagle and cork should send fewer segments." );
+  }
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
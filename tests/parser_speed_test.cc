@@ -0,0 +1,125 @@
+#include "ethernet_header.hh"
+#include "ipv4_header.hh"
+#include "parser.hh"
+#include "tcp_segment.hh"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// Parsing speed of Parser (over a list of strings) and SpanParser (over one contiguous buffer), for the headers
+// of a received frame.
+
+namespace {
+
+string concat( const vector<string>& pieces )
+{
+  string ret;
+  for ( const auto& x : pieces ) {
+    ret += x;
+  }
+  return ret;
+}
+
+// Parse `wire` `rounds` times with each parser, and report how many parses per second
+template<class Parse>
+void speed_test( string_view what, const string& wire, const size_t rounds, Parse&& parse )
+{
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  const vector<string> pieces { wire };
+  double parser_rate {};
+  for ( const bool contiguous : { false, true } ) {
+    const auto start_time = steady_clock::now();
+    for ( size_t i = 0; i < rounds; ++i ) {
+      bool ok {};
+      if ( contiguous ) {
+        SpanParser parser { wire };
+        ok = parse( parser );
+      } else {
+        Parser parser { pieces };
+        ok = parse( parser );
+      }
+      if ( not ok ) {
+        throw runtime_error( "failed to parse " + string { what } );
+      }
+    }
+    const auto seconds = duration_cast<duration<double>>( steady_clock::now() - start_time ).count();
+    const double rate = static_cast<double>( rounds ) / seconds / 1e6;
+    parser_rate = contiguous ? parser_rate : rate;
+
+    const string_view name = contiguous ? "SpanParser" : "Parser";
+    cout << what << " (" << wire.size() << " bytes) with " << name << ": " << fixed << setprecision( 2 ) << rate
+         << " million parses/s";
+    if ( contiguous ) {
+      cout << " (" << rate / parser_rate << "x Parser)";
+    }
+    cout << ".\n";
+    debug_output << "             " << what << " " << name << ": " << fixed << setprecision( 2 ) << rate
+                 << " M/s\n";
+  }
+}
+
+} // namespace
+
+void program_body()
+{
+  EthernetHeader ethernet { { 0x02, 0, 0, 0, 0, 1 }, { 0x02, 0, 0, 0, 0, 2 }, EthernetHeader::TYPE_IPv4 };
+  speed_test( "Ethernet header", concat( serialize( ethernet ) ), 2'000'000, [&]( auto& parser ) {
+    EthernetHeader header {};
+    header.parse( parser );
+    return not parser.has_error() and header.type == ethernet.type;
+  } );
+
+  TCPSegment seg;
+  seg.udinfo.src_port = 1234;
+  seg.udinfo.dst_port = 80;
+  seg.message.sender.seqno = Wrap32 { 1 };
+  seg.message.sender.TSval = 100;
+  seg.message.sender.payload = string( 1000, 'x' );
+  seg.message.receiver.ackno = Wrap32 { 2 };
+  seg.message.receiver.window_size = 50000;
+  seg.message.receiver.TSecr = 99;
+
+  IPv4Header ip;
+  ip.src = 0x0a000001;
+  ip.dst = 0x0a000002;
+  ip.len = static_cast<uint16_t>( IPv4Header::LENGTH + seg.header_length() + seg.message.sender.payload.size() );
+  ip.compute_checksum();
+  speed_test( "IPv4 header", concat( serialize( ip ) ), 1'000'000, [&]( auto& parser ) {
+    IPv4Header header;
+    header.parse( parser );
+    return not parser.has_error() and header.dst == ip.dst;
+  } );
+
+  seg.compute_checksum( ip.pseudo_checksum() );
+  speed_test( "TCP segment", concat( serialize( seg ) ), 500'000, [&]( auto& parser ) {
+    TCPSegment parsed;
+    parsed.parse( parser, ip.pseudo_checksum() );
+    return not parser.has_error() and parsed.message.sender.payload.size() == 1000;
+  } );
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+#include "tcp_peer.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+const Wrap32 peer_isn { 1000 };
+const Wrap32 remote_isn { 5000 };
+
+// A segment from the remote side: `payload` at stream offset `offset`, acknowledging the peer's SYN
+TCPMessage data( uint32_t offset, string payload, bool fin = false )
+{
+  TCPMessage msg;
+  msg.sender.seqno = remote_isn + 1 + offset;
+  msg.sender.payload = move( payload );
+  msg.sender.FIN = fin;
+  msg.receiver.ackno = peer_isn + 1;
+  msg.receiver.window_size = 10000;
+  return msg;
+}
+} // namespace
+
+int main()
+{
+  try {
+    {
+      // without a delay, every segment is acknowledged at once
+      TCPConfig cfg;
+      cfg.isn = peer_isn;
+      TCPPeer peer { cfg };
+      vector<TCPMessage> sent;
+      const auto transmit = [&]( TCPMessage msg ) { sent.push_back( move( msg ) ); };
+
+      TCPMessage syn;
+      syn.sender.seqno = remote_isn;
+      syn.sender.SYN = true;
+      syn.receiver.window_size = 10000;
+      peer.receive( syn, transmit );
+      peer.receive( data( 0, "abc" ), transmit );
+      peer.receive( data( 3, "def" ), transmit );
+      test_should_be( sent.size(), size_t { 3 } );
+      test_should_be( peer.pure_acks_sent(), uint64_t { 2 } );
+      test_should_be( peer.segments_received(), uint64_t { 3 } );
+    }
+
+    {
+      TCPConfig cfg;
+      cfg.isn = peer_isn;
+      cfg.ack_delay_ms = 40;
+      TCPPeer peer { cfg };
+      vector<TCPMessage> sent;
+      const auto transmit = [&]( TCPMessage msg ) { sent.push_back( move( msg ) ); };
+      const auto last_ackno = [&] { return sent.back().receiver.ackno.value(); };
+
+      // the SYN is answered at once
+      TCPMessage syn;
+      syn.sender.seqno = remote_isn;
+      syn.sender.SYN = true;
+      syn.receiver.window_size = 10000;
+      peer.receive( syn, transmit );
+      test_should_be( sent.size(), size_t { 1 } );
+      test_should_be( sent.back().sender.SYN, true );
+
+      // in-order data waits for the timer...
+      peer.receive( data( 0, string( 500, 'a' ) ), transmit );
+      test_should_be( sent.size(), size_t { 1 } );
+      peer.tick( 39, transmit );
+      test_should_be( sent.size(), size_t { 1 } );
+      peer.tick( 1, transmit );
+      test_should_be( sent.size(), size_t { 2 } );
+      test_should_be( last_ackno() == remote_isn + 501, true );
+
+      // ... or for a second full-sized segment
+      peer.receive( data( 500, string( 1000, 'b' ) ), transmit );
+      test_should_be( sent.size(), size_t { 2 } );
+      peer.receive( data( 1500, string( 1000, 'c' ) ), transmit );
+      test_should_be( sent.size(), size_t { 3 } );
+      test_should_be( last_ackno() == remote_isn + 2501, true );
+      peer.tick( 100, transmit );
+      test_should_be( sent.size(), size_t { 3 } ); // nothing left to acknowledge
+
+      // out-of-order data gets an immediate duplicate ACK, and so does the segment that fills the hole
+      peer.receive( data( 3500, string( 100, 'e' ) ), transmit );
+      test_should_be( sent.size(), size_t { 4 } );
+      test_should_be( last_ackno() == remote_isn + 2501, true );
+      peer.receive( data( 2500, string( 1000, 'd' ) ), transmit );
+      test_should_be( sent.size(), size_t { 5 } );
+      test_should_be( last_ackno() == remote_isn + 3601, true );
+
+      // as does a FIN
+      peer.receive( data( 3600, "f", true ), transmit );
+      test_should_be( sent.size(), size_t { 6 } );
+      test_should_be( last_ackno() == remote_isn + 3603, true );
+
+      test_should_be( peer.segments_received(), uint64_t { 7 } );
+      test_should_be( peer.pure_acks_sent(), uint64_t { 5 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -286,6 +286,51 @@ int main()
       test.execute( BytesPushed( 27 ) );
       test.execute( ReadAll( "I am sentient, hello world!" ) );
     }
+
+    {
+      ReassemblerTestHarness test { "in-order insert overlapping stored sections", 16 };
+
+      test.execute( Insert { "cde", 2 } );
+      test.execute( Insert { "fgh", 5 } );
+      test.execute( Insert { "jk", 9 } );
+      test.execute( StoredInserts( 3 ) );
+      test.execute( BytesPending( 8 ) );
+
+      test.execute( Insert { "abcd", 0 } );
+      test.execute( InOrderInserts( 1 ) );
+      test.execute( BytesPushed( 8 ) );
+      test.execute( BytesPending( 2 ) );
+
+      test.execute( Insert { "hij", 7 } );
+      test.execute( InOrderInserts( 2 ) );
+      test.execute( BytesPushed( 11 ) );
+      test.execute( BytesPending( 0 ) );
+      test.execute( ReadAll( "abcdefghijk" ) );
+
+      test.execute( Insert { "lmn", 11 } );
+      test.execute( InOrderInserts( 3 ) );
+      test.execute( ReadAll( "lmn" ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "batch of overlapping, out-of-order sections", 16 };
+
+      test.execute( Insert { "ef", 4 } );
+      test.execute( InsertBatch {}.add( "klm", 10 ).add( "ij", 8 ).add( "hi", 7 ).add( "qrs", 16 ) );
+      test.execute( BytesPushed( 0 ) );
+      test.execute( BytesPending( 8 ) );
+
+      test.execute( InsertBatch {}.add( "def", 3 ).add( "abc", 0 ).add( "", 14, true ).add( "bcd", 1 ) );
+      test.execute( BytesPushed( 6 ) );
+      test.execute( BytesPending( 6 ) );
+
+      test.execute( InsertBatch {}.add( "ghijklmn", 6 ).add( "efg", 4 ) );
+      test.execute( BytesPushed( 14 ) );
+      test.execute( BytesPending( 0 ) );
+      test.execute( IsFinished( false ) );
+      test.execute( ReadAll( "abcdefghijklmn" ) );
+      test.execute( IsFinished( true ) );
+    }
   } catch ( const exception& e ) {
     cerr << "Exception: " << e.what() << endl;
     return EXIT_FAILURE;
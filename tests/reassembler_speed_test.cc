@@ -1,3 +1,4 @@
+#include "buffer_pool.hh"
 #include "reassembler.hh"
 
 #include <algorithm>
@@ -8,14 +9,50 @@
 #include <iostream>
 #include <queue>
 #include <random>
+#include <string_view>
 #include <tuple>
 
 using namespace std;
 using namespace std::chrono;
 
+using Segments = queue<tuple<uint64_t, string, bool>>;
+
+// Each segment is two capacities long, and they overlap: offset by 2, then 0, then 1.
+Segments overlapping_segments( const string& data, const size_t capacity )
+{
+  Segments split_data;
+  for ( size_t i = 0; i < data.size(); i += capacity ) {
+    split_data.emplace( i + 2, data.substr( i + 2, capacity * 2 ), i + 2 + capacity * 2 >= data.size() );
+    split_data.emplace( i, data.substr( i, capacity * 2 ), i + capacity * 2 >= data.size() );
+    split_data.emplace( i + 1, data.substr( i + 1, capacity * 2 ), i + 1 + capacity * 2 >= data.size() );
+  }
+  return split_data;
+}
+
+// Adversarial reordering: each window's worth of small segments arrives last-to-first, and every
+// segment is sent twice with overlapping neighbors, so nothing can be delivered until the window's
+// first segment shows up.
+Segments reversed_segments( const string& data, const size_t capacity )
+{
+  constexpr size_t segment_size = 64;
+  Segments split_data;
+  for ( size_t window = 0; window < data.size(); window += capacity ) {
+    const size_t window_end = min( data.size(), window + capacity );
+    for ( size_t i = window_end - segment_size; i >= window + segment_size; i -= segment_size ) {
+      split_data.emplace( i, data.substr( i, segment_size ), i + segment_size >= data.size() );
+      split_data.emplace( i - segment_size / 2, data.substr( i - segment_size / 2, segment_size ), false );
+    }
+    split_data.emplace( window, data.substr( window, segment_size ), window + segment_size >= data.size() );
+  }
+  return split_data;
+}
+
 void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-parameters)
                  const size_t capacity,     // NOLINT(bugprone-easily-swappable-parameters)
-                 const size_t random_seed ) // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t random_seed,  // NOLINT(bugprone-easily-swappable-parameters)
+                 const Reassembler::Engine engine,
+                 const string_view pattern_name,
+                 Segments ( *pattern )( const string&, size_t ) )
 {
   // Generate the data to be written
   const string data = [&] {
@@ -29,14 +66,9 @@ void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-
   }();
 
   // Split the data into segments before writing
-  queue<tuple<uint64_t, string, bool>> split_data;
-  for ( size_t i = 0; i < data.size(); i += capacity ) {
-    split_data.emplace( i + 2, data.substr( i + 2, capacity * 2 ), i + 2 + capacity * 2 >= data.size() );
-    split_data.emplace( i, data.substr( i, capacity * 2 ), i + capacity * 2 >= data.size() );
-    split_data.emplace( i + 1, data.substr( i + 1, capacity * 2 ), i + 1 + capacity * 2 >= data.size() );
-  }
+  Segments split_data = pattern( data, capacity );
 
-  Reassembler reassembler { ByteStream { capacity } };
+  Reassembler reassembler { ByteStream { capacity }, engine };
 
   string output_data;
   output_data.reserve( data.size() );
@@ -71,11 +103,20 @@ void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-
   fstream debug_output;
   debug_output.open( "/dev/tty" );
 
-  cout << "Reassembler to ByteStream with capacity=" << capacity << " reached " << fixed << setprecision( 2 )
-       << gigabits_per_second << " Gbit/s.\n";
+  const string_view engine_name = engine == Reassembler::Engine::Bitmap ? "bitmap" : "map";
+  cout << "Reassembler (" << engine_name << ", " << pattern_name << ") to ByteStream with capacity=" << capacity
+       << " reached " << fixed << setprecision( 2 ) << gigabits_per_second << " Gbit/s.\n";
+
+  debug_output << "             Reassembler throughput (" << engine_name << ", " << pattern_name
+               << "): " << fixed << setprecision( 2 ) << gigabits_per_second << " Gbit/s\n";
 
-  debug_output << "             Reassembler throughput: " << fixed << setprecision( 2 ) << gigabits_per_second
-               << " Gbit/s\n";
+  const auto& paths = reassembler.stats();
+  cout << "Segments: " << paths.in_order << " in order, " << paths.out_of_order << " stored, " << paths.discarded
+       << " discarded.\n";
+
+  const auto& pool = BufferPool::local().stats();
+  cout << "Buffer pool hit rate " << fixed << setprecision( 1 ) << 100 * pool.hit_rate() << "%, high-water mark "
+       << pool.high_water_bytes / 1024 << " KiB.\n";
 
   if ( gigabits_per_second < 0.1 ) {
     throw runtime_error( "Reassembler did not meet minimum speed of 0.1 Gbit/s." );
@@ -84,7 +125,10 @@ void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-
 
 void program_body()
 {
-  speed_test( 10000, 1500, 1370 );
+  for ( const auto engine : { Reassembler::Engine::Map, Reassembler::Engine::Bitmap } ) {
+    speed_test( 10000, 1500, 1370, engine, "overlapping", overlapping_segments );
+    speed_test( 1000, 16384, 1370, engine, "reversed", reversed_segments );
+  }
 }
 
 int main()
@@ -4,9 +4,12 @@
 #include "common.hh"
 #include "reassembler.hh"
 
+#include <cstdlib>
 #include <optional>
 #include <sstream>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 template<std::derived_from<TestStep<ByteStream>> T>
 struct ReassemblerTestStep : public TestStep<Reassembler>
@@ -24,13 +27,24 @@ struct ReassemblerTestStep : public TestStep<Reassembler>
   void execute( const Reassembler& r ) const { step_.execute( r.reader() ); }
 };
 
+// The engine under test: Engine::Map unless the REASSEMBLER_ENGINE environment variable says "bitmap"
+inline Reassembler::Engine reassembler_engine_under_test()
+{
+  const char* const engine = std::getenv( "REASSEMBLER_ENGINE" ); // NOLINT(*-mt-unsafe)
+  return engine and std::string_view { engine } == "bitmap" ? Reassembler::Engine::Bitmap
+                                                            : Reassembler::Engine::Map;
+}
+
 class ReassemblerTestHarness : public TestHarness<Reassembler>
 {
 public:
-  ReassemblerTestHarness( std::string test_name, uint64_t capacity )
+  ReassemblerTestHarness( std::string test_name,
+                          uint64_t capacity,
+                          Reassembler::Engine engine = reassembler_engine_under_test() )
     : TestHarness( move( test_name ),
-                   "capacity=" + std::to_string( capacity ),
-                   { Reassembler { ByteStream { capacity } } } )
+                   "capacity=" + std::to_string( capacity )
+                     + ( engine == Reassembler::Engine::Bitmap ? ", engine=bitmap" : "" ),
+                   { Reassembler { ByteStream { capacity }, engine } } )
   {}
 
   template<std::derived_from<TestStep<ByteStream>> T>
@@ -49,6 +63,20 @@ struct BytesPending : public ConstExpectNumber<Reassembler, uint64_t>
   uint64_t value( const Reassembler& r ) const override { return r.bytes_pending(); }
 };
 
+struct InOrderInserts : public ConstExpectNumber<Reassembler, uint64_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "stats().in_order"; }
+  uint64_t value( const Reassembler& r ) const override { return r.stats().in_order; }
+};
+
+struct StoredInserts : public ConstExpectNumber<Reassembler, uint64_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "stats().out_of_order"; }
+  uint64_t value( const Reassembler& r ) const override { return r.stats().out_of_order; }
+};
+
 struct Insert : public Action<Reassembler>
 {
   std::string data_;
@@ -75,3 +103,32 @@ struct Insert : public Action<Reassembler>
 
   void execute( Reassembler& r ) const override { r.insert( first_index_, data_, is_last_substring_ ); }
 };
+
+struct InsertBatch : public Action<Reassembler>
+{
+  std::vector<Reassembler::Segment> segments_ {};
+
+  InsertBatch& add( std::string data, uint64_t first_index, bool is_last = false )
+  {
+    segments_.push_back( { first_index, std::move( data ), is_last } );
+    return *this;
+  }
+
+  std::string description() const override
+  {
+    std::ostringstream ss;
+    ss << "insert batch {";
+    for ( const auto& [first_index, data, is_last] : segments_ ) {
+      ss << " \"" << Printer::prettify( data ) << "\" @ index " << first_index << ( is_last ? " [last]" : "" )
+         << ";";
+    }
+    ss << " }";
+    return ss.str();
+  }
+
+  void execute( Reassembler& r ) const override
+  {
+    auto segments = segments_;
+    r.insert_batch( segments );
+  }
+};
@@ -8,6 +8,7 @@
 #include <optional>
 #include <sstream>
 #include <utility>
+#include <vector>
 
 template<std::derived_from<TestStep<Reassembler>> T>
 struct DirectReassemblerTest : public TestStep<TCPReceiver>
@@ -43,7 +44,7 @@ public:
   TCPReceiverTestHarness( std::string test_name, uint64_t capacity )
     : TestHarness( move( test_name ),
                    "capacity=" + std::to_string( capacity ),
-                   { TCPReceiver { Reassembler { ByteStream { capacity } } } } )
+                   { TCPReceiver { Reassembler { ByteStream { capacity }, reassembler_engine_under_test() } } } )
   {}
 
   template<std::derived_from<TestStep<Reassembler>> T>
@@ -61,11 +62,25 @@ public:
   using TestHarness<TCPReceiver>::execute;
 };
 
-struct ExpectWindow : public ExpectNumber<TCPReceiver, uint16_t>
+struct ExpectWindow : public ExpectNumber<TCPReceiver, uint32_t>
 {
   using ExpectNumber::ExpectNumber;
   std::string name() const override { return "window_size"; }
-  uint16_t value( TCPReceiver& rs ) const override { return rs.send().window_size; }
+  uint32_t value( TCPReceiver& rs ) const override { return rs.send().window_size; }
+};
+
+struct ExpectTSecr : public ExpectNumber<TCPReceiver, std::optional<uint32_t>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "TSecr"; }
+  std::optional<uint32_t> value( TCPReceiver& rs ) const override { return rs.send().TSecr; }
+};
+
+struct ExpectPAWSRejected : public ExpectNumber<TCPReceiver, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "paws_rejected"; }
+  uint64_t value( TCPReceiver& rs ) const override { return rs.paws_rejected(); }
 };
 
 struct ExpectAckno : public ExpectNumber<TCPReceiver, std::optional<Wrap32>>
@@ -83,6 +98,36 @@ struct ExpectReset : public ExpectBool<TCPReceiver>
   bool value( TCPReceiver& rs ) const override { return rs.send().RST; }
 };
 
+struct ExpectSack : public Expectation<TCPReceiver>
+{
+  std::vector<std::pair<Wrap32, Wrap32>> blocks_;
+
+  explicit ExpectSack( std::vector<std::pair<Wrap32, Wrap32>> blocks ) : blocks_( std::move( blocks ) ) {}
+
+  static std::string describe( const std::vector<std::pair<Wrap32, Wrap32>>& blocks )
+  {
+    std::string ret { "{" };
+    for ( const auto& [left, right] : blocks ) {
+      ret += " [" + to_string( left ) + ", " + to_string( right ) + ")";
+    }
+    return ret + " }";
+  }
+
+  std::string description() const override { return "SACK blocks = " + describe( blocks_ ); }
+
+  void execute( TCPReceiver& rs ) const override
+  {
+    std::vector<std::pair<Wrap32, Wrap32>> actual;
+    for ( const auto& [left, right] : rs.send().sack ) {
+      actual.emplace_back( left, right );
+    }
+    if ( actual != blocks_ ) {
+      throw ExpectationViolation( "The TCPReceiver should have sent SACK blocks " + describe( blocks_ )
+                                  + ", but instead it sent " + describe( actual ) + "." );
+    }
+  }
+};
+
 struct ExpectAcknoBetween : public Expectation<TCPReceiver>
 {
   Wrap32 isn_;
@@ -118,6 +163,15 @@ struct HasAckno : public ExpectBool<TCPReceiver>
   bool value( TCPReceiver& rs ) const override { return rs.send().ackno.has_value(); }
 };
 
+struct SetWindowShift : public Action<TCPReceiver>
+{
+  uint8_t shift_;
+
+  explicit SetWindowShift( uint8_t shift ) : shift_( shift ) {}
+  std::string description() const override { return "window scaling with shift " + std::to_string( shift_ ); }
+  void execute( TCPReceiver& rs ) const override { rs.set_window_shift( shift_ ); }
+};
+
 struct SegmentArrives : public Action<TCPReceiver>
 {
   TCPSenderMessage msg_ {};
@@ -155,6 +209,12 @@ struct SegmentArrives : public Action<TCPReceiver>
     return *this;
   }
 
+  SegmentArrives& with_TSval( uint32_t TSval )
+  {
+    msg_.TSval = TSval;
+    return *this;
+  }
+
   SegmentArrives& without_ackno()
   {
     ackno_expected_ = HasAckno { false };
@@ -181,6 +241,9 @@ struct SegmentArrives : public Action<TCPReceiver>
     if ( msg_.FIN ) {
       ss << " +FIN";
     }
+    if ( msg_.TSval ) {
+      ss << " TSval=" << *msg_.TSval;
+    }
     ss << ")";
 
     if ( ackno_expected_.value_ ) {
@@ -191,3 +254,25 @@ struct SegmentArrives : public Action<TCPReceiver>
     return ss.str();
   }
 };
+
+struct SegmentsArrive : public Action<TCPReceiver>
+{
+  std::vector<TCPSenderMessage> msgs_ {};
+
+  SegmentsArrive& add( const SegmentArrives& segment )
+  {
+    msgs_.push_back( segment.msg_ );
+    return *this;
+  }
+
+  void execute( TCPReceiver& rs ) const override
+  {
+    auto msgs = msgs_;
+    rs.receive_batch( msgs );
+  }
+
+  std::string description() const override
+  {
+    return "receive a batch of " + std::to_string( msgs_.size() ) + " segments";
+  }
+};
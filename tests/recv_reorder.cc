@@ -127,6 +127,35 @@ int main()
       test.execute( BytesPushed { 8 } );
     }
 
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "out-of-order segments reported as SACK blocks", 2358 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( ExpectSack { {} } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 10 ).with_data( "jkl" ) );
+      test.execute( ExpectSack { { { Wrap32 { isn + 10 }, Wrap32 { isn + 13 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 13 ).with_data( "mn" ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "ef" ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 20 ).with_data( "t" ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 25 ).with_data( "y" ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 30 ).with_data( "3" ) );
+      test.execute( ExpectSack { { { Wrap32 { isn + 5 }, Wrap32 { isn + 7 } },
+                                   { Wrap32 { isn + 10 }, Wrap32 { isn + 15 } },
+                                   { Wrap32 { isn + 20 }, Wrap32 { isn + 21 } },
+                                   { Wrap32 { isn + 25 }, Wrap32 { isn + 26 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcdefg" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 8 } } );
+      test.execute( ExpectSack { { { Wrap32 { isn + 10 }, Wrap32 { isn + 15 } },
+                                   { Wrap32 { isn + 20 }, Wrap32 { isn + 21 } },
+                                   { Wrap32 { isn + 25 }, Wrap32 { isn + 26 } },
+                                   { Wrap32 { isn + 30 }, Wrap32 { isn + 31 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 8 ).with_data( "hi" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 15 } } );
+      test.execute( ExpectSack { { { Wrap32 { isn + 20 }, Wrap32 { isn + 21 } },
+                                   { Wrap32 { isn + 25 }, Wrap32 { isn + 26 } },
+                                   { Wrap32 { isn + 30 }, Wrap32 { isn + 31 } } } } );
+    }
   } catch ( const exception& e ) {
     cerr << e.what() << endl;
     return 1;
@@ -98,6 +98,33 @@ void do_test_2( const TCPConfig& cfg, default_random_engine& rd )
   test_2.execute( ReadAll { d } );
 }
 
+void do_test_3( const TCPConfig& cfg, default_random_engine& rd )
+{
+  const Wrap32 rx_isn( rd() );
+  TCPReceiverTestHarness test_3 { "batches of overlapping out-of-order segments", cfg.recv_capacity };
+  test_3.execute( SegmentArrives {}.with_seqno( rx_isn ).with_syn() );
+  vector<tuple<size_t, size_t>> seq_size;
+  for ( size_t off = 0; off < cfg.recv_capacity; off += TCPConfig::MAX_PAYLOAD_SIZE / 2 ) {
+    seq_size.emplace_back( off, min( TCPConfig::MAX_PAYLOAD_SIZE, cfg.recv_capacity - off ) );
+  }
+  shuffle( seq_size.begin(), seq_size.end(), rd );
+
+  string d( cfg.recv_capacity, 0 );
+  generate( d.begin(), d.end(), [&] { return rd(); } );
+
+  for ( size_t i = 0; i < seq_size.size(); ) {
+    SegmentsArrive batch;
+    for ( const size_t end = min( seq_size.size(), i + 1 + rd() % 64 ); i < end; ++i ) {
+      const auto [off, sz] = seq_size[i];
+      batch.add( SegmentArrives {}.with_seqno( rx_isn + 1 + off ).with_data( d.substr( off, sz ) ) );
+    }
+    test_3.execute( batch );
+  }
+
+  test_3.execute( BytesPending { 0 } );
+  test_3.execute( ReadAll { d } );
+}
+
 int main()
 {
   try {
@@ -114,6 +141,11 @@ int main()
     for ( unsigned rep_no = 0; rep_no < NREPS; ++rep_no ) {
       do_test_2( cfg, rd );
     }
+
+    // the same, delivered in batches
+    for ( unsigned rep_no = 0; rep_no < NREPS; ++rep_no ) {
+      do_test_3( cfg, rd );
+    }
   } catch ( const exception& e ) {
     cerr << e.what() << endl;
     return 1;
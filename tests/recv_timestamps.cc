@@ -0,0 +1,73 @@
+#include "receiver_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      const uint32_t isn = 8000;
+      TCPReceiverTestHarness test { "no timestamps, no TSecr", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abc" ) );
+      test.execute( ExpectTSecr { nullopt } );
+    }
+
+    {
+      const uint32_t isn = 8000;
+      TCPReceiverTestHarness test { "TSecr echoes the latest in-order TSval", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ).with_TSval( 1000 ) );
+      test.execute( ExpectTSecr { 1000 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abc" ).with_TSval( 1010 ) );
+      test.execute( ExpectTSecr { 1010 } );
+
+      // a segment beyond a hole isn't the one the ACK acknowledges
+      test.execute( SegmentArrives {}.with_seqno( isn + 10 ).with_data( "jkl" ).with_TSval( 1020 ) );
+      test.execute( ExpectTSecr { 1010 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 4 ).with_data( "defghi" ).with_TSval( 1030 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 13 } } );
+      test.execute( ExpectTSecr { 1030 } );
+    }
+
+    {
+      const uint32_t isn = 8000;
+      TCPReceiverTestHarness test { "PAWS drops old duplicates", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ).with_TSval( 1000 ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abc" ).with_TSval( 1010 ) );
+
+      // an old segment carrying data we haven't seen, as if the sequence numbers had wrapped around
+      test.execute( SegmentArrives {}.with_seqno( isn + 4 ).with_data( "xyz" ).with_TSval( 990 ) );
+      test.execute( ExpectPAWSRejected { 1 } );
+      test.execute( ExpectAckno { Wrap32 { isn + 4 } } );
+      test.execute( BytesPushed { 3 } );
+
+      test.execute( SegmentArrives {}.with_seqno( isn + 4 ).with_data( "def" ).with_TSval( 1010 ) );
+      test.execute( ExpectPAWSRejected { 1 } );
+      test.execute( ExpectAckno { Wrap32 { isn + 7 } } );
+      test.execute( ReadAll { "abcdef" } );
+    }
+
+    {
+      const uint32_t isn = 8000;
+      TCPReceiverTestHarness test { "timestamps compare modulo 2^32", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ).with_TSval( 0xffff'fff0 ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abc" ).with_TSval( 0x10 ) );
+      test.execute( ExpectPAWSRejected { 0 } );
+      test.execute( ExpectTSecr { 0x10 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 4 ).with_data( "def" ).with_TSval( 0xffff'fff8 ) );
+      test.execute( ExpectPAWSRejected { 1 } );
+      test.execute( ExpectAckno { Wrap32 { isn + 4 } } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
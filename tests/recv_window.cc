@@ -105,6 +105,20 @@ int main()
       test.execute( BytesPending( 0 ) );
     }
 
+    {
+      const size_t cap = 1'000'000;
+      const uint32_t isn = 4321;
+      TCPReceiverTestHarness test { "window scaling lifts the 64 KiB limit", cap };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( ExpectWindow { UINT16_MAX } );
+      test.execute( SetWindowShift { 2 } );
+      test.execute( ExpectWindow { UINT16_MAX << 2 } );
+      test.execute( SetWindowShift { 4 } );
+      test.execute( ExpectWindow { cap } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( string( 100'000, 'x' ) ) );
+      test.execute( ExpectWindow { cap - 100'000 } );
+    }
+
   } catch ( const exception& e ) {
     cerr << e.what() << endl;
     return 1;
@@ -0,0 +1,171 @@
+#include "congestion_control.hh"
+#include "random.hh"
+#include "sender_test_harness.hh"
+#include "test_should_be.hh"
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.congestion = CongestionControl::Algorithm::Reno;
+
+      TCPSenderTestHarness test { "Reno slow start", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { 4000 } );
+
+      // the initial window is four segments, however much the receiver allows
+      test.execute( Push { string( 20000, 'a' ) } );
+      for ( uint32_t i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ).with_seqno( isn + 1 + 1000 * i ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 4000 } );
+
+      // each acknowledged segment opens the window by one more
+      test.execute( AckReceived { Wrap32 { isn + 1001 } }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { 5000 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 4001 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 5001 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // but a stretch ACK opens it by at most two segments
+      test.execute( AckReceived { Wrap32 { isn + 4001 } }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { 7000 } );
+      test.execute( ExpectSeqnosInFlight { 7000 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.congestion = CongestionControl::Algorithm::Reno;
+
+      TCPSenderTestHarness test { "Receiver's window still applies", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 1500 ) );
+      test.execute( Push { string( 5000, 'b' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 500 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectCongestionWindow { 4000 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.congestion = CongestionControl::Algorithm::Reno;
+
+      TCPSenderTestHarness test { "Reno timeout, then congestion avoidance", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 10000, 'c' ) } );
+      for ( uint32_t i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      }
+      test.execute( ExpectNoSegment {} );
+
+      // a timeout halves ssthresh and starts over from one segment
+      test.execute( Tick { cfg.rt_timeout - 1U } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectCongestionWindow { 1000 } );
+      test.execute( ExpectSlowStartThreshold { 2000 } );
+
+      test.execute( AckReceived { Wrap32 { isn + 1001 } }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { 2000 } );
+      test.execute( ExpectNoSegment {} ); // three segments are still in flight
+
+      // past ssthresh, the window grows by one segment per window of data acknowledged
+      test.execute( AckReceived { Wrap32 { isn + 4001 } }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { 3000 } );
+      for ( uint32_t i = 0; i < 3; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 4001 + 1000 * i ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 7001 } }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { 4000 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.congestion = CongestionControl::Algorithm::Cubic;
+
+      TCPSenderTestHarness test { "CUBIC timeout", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 10000, 'd' ) } );
+      for ( uint32_t i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      }
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectCongestionWindow { 1000 } );
+      test.execute( ExpectSlowStartThreshold { 2800 } ); // multiplicative decrease by 0.7, not 0.5
+
+      test.execute( AckReceived { Wrap32 { isn + 4001 } }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { 3000 } );
+      test.execute( ExpectSeqnosInFlight { 3000 } );
+    }
+
+    {
+      // the CUBIC window function: concave up to the previous maximum, then convex beyond it
+      Cubic cubic { 1000 };
+      while ( cubic.cwnd() < 20000 ) {
+        cubic.on_ack( 1000, 0, 0 );
+      }
+      test_should_be( cubic.cwnd(), uint64_t { 20000 } );
+      cubic.on_loss( 20000, 0 );
+      test_should_be( cubic.cwnd(), uint64_t { 14000 } );
+      test_should_be( cubic.in_slow_start(), false );
+
+      // one segment acknowledged every 100 ms
+      array<uint64_t, 11> cwnd_at {};
+      for ( uint64_t now = 0; now <= 10000; now += 100 ) {
+        cubic.on_ack( 1000, 0, now );
+        if ( now % 1000 == 0 ) {
+          cwnd_at[now / 1000] = cubic.cwnd();
+        }
+      }
+      test_should_be( cwnd_at[1] > 14000 and cwnd_at[1] < 20000, true );
+      test_should_be( cwnd_at[3] < 20000, true );
+      test_should_be( cwnd_at[3] - cwnd_at[2] < cwnd_at[1] - cwnd_at[0], true ); // flattening near the old max
+      test_should_be( cwnd_at[5] > 20000, true );
+      test_should_be( cwnd_at[6] - cwnd_at[5] > cwnd_at[4] - cwnd_at[3], true ); // probing beyond it
+
+      // a timeout cuts the window to one segment
+      Cubic fresh { 1000 };
+      test_should_be( fresh.cwnd(), uint64_t { 4000 } );
+      fresh.on_rto( 4000, 0 );
+      test_should_be( fresh.cwnd(), uint64_t { 1000 } );
+      test_should_be( fresh.ssthresh(), uint64_t { 2800 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
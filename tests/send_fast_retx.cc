@@ -0,0 +1,159 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.fast_retransmit = true;
+
+      TCPSenderTestHarness test { "Third duplicate ACK retransmits, partial ACKs fill the next hole", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      for ( const string data : { "a", "b", "c", "d", "e" } ) {
+        test.execute( Push { data } );
+        test.execute( ExpectMessage {}.with_data( data ) );
+      }
+      test.execute( AckReceived { Wrap32 { isn + 2 } } );
+
+      // "b" and "c" were lost; "d" and "e" each produce a duplicate ACK
+      test.execute( AckReceived { Wrap32 { isn + 2 } } );
+      test.execute( AckReceived { Wrap32 { isn + 2 } } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 2 } } );
+      test.execute( ExpectMessage {}.with_data( "b" ).with_seqno( isn + 2 ) );
+      test.execute( ExpectInFastRecovery { true } );
+      test.execute( AckReceived { Wrap32 { isn + 2 } } );
+      test.execute( ExpectNoSegment {} );
+
+      // NewReno: an ACK short of everything sent before the loss means the next segment was lost too
+      test.execute( AckReceived { Wrap32 { isn + 3 } } );
+      test.execute( ExpectMessage {}.with_data( "c" ).with_seqno( isn + 3 ) );
+      test.execute( ExpectInFastRecovery { true } );
+      test.execute( AckReceived { Wrap32 { isn + 6 } } );
+      test.execute( ExpectInFastRecovery { false } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectFastRetransmissions { 2 } );
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+
+      // nothing outstanding: repeated ACKs are not duplicates
+      for ( int i = 0; i < 4; ++i ) {
+        test.execute( AckReceived { Wrap32 { isn + 6 } } );
+      }
+      test.execute( ExpectNoSegment {} );
+
+      test.execute( Push { "f" } );
+      test.execute( ExpectMessage {}.with_data( "f" ) );
+      for ( int i = 0; i < 3; ++i ) {
+        test.execute( AckReceived { Wrap32 { isn + 6 } } );
+      }
+      test.execute( ExpectMessage {}.with_data( "f" ) );
+      test.execute( ExpectFastRetransmissions { 3 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.fast_retransmit = true;
+
+      TCPSenderTestHarness test { "A window update is not a duplicate ACK", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 10 ) );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 11 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 12 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 13 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectFastRetransmissions { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.fast_retransmit = true;
+
+      TCPSenderTestHarness test { "After a timeout, old duplicate ACKs don't retransmit again", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      test.execute( Push { "a" } );
+      test.execute( Push { "b" } );
+      test.execute( Push { "c" } );
+      test.execute( ExpectMessage {}.with_data( "a" ) );
+      test.execute( ExpectMessage {}.with_data( "b" ) );
+      test.execute( ExpectMessage {}.with_data( "c" ) );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_data( "a" ) );
+      for ( int i = 0; i < 3; ++i ) {
+        test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectInFastRecovery { false } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.fast_retransmit = true;
+      cfg.congestion = CongestionControl::Algorithm::Reno;
+
+      TCPSenderTestHarness test { "Fast recovery with Reno", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 10000, 'x' ) } );
+      for ( int i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      }
+      test.execute( AckReceived { Wrap32 { isn + 1001 } }.with_win( 60000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      test.execute( ExpectSeqnosInFlight { 5000 } );
+
+      // on the third duplicate: ssthresh = flight / 2, and cwnd is inflated by the three segments that left
+      for ( int i = 0; i < 3; ++i ) {
+        test.execute( AckReceived { Wrap32 { isn + 1001 } }.with_win( 60000 ) );
+      }
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+      test.execute( ExpectCongestionWindow { 2500 } );
+      test.execute( ExpectSlowStartThreshold { 2500 } );
+      test.execute( ExpectMessage {}.with_payload_size( 500 ).with_seqno( isn + 6001 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // each further duplicate lets one more segment out
+      test.execute( AckReceived { Wrap32 { isn + 1001 } }.with_win( 60000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 6501 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // the full ACK deflates the window back to ssthresh, without growing it
+      test.execute( AckReceived { Wrap32 { isn + 6001 } }.with_win( 60000 ) );
+      test.execute( ExpectInFastRecovery { false } );
+      test.execute( ExpectCongestionWindow { 2500 } );
+      test.execute( ExpectSeqnosInFlight { 2500 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
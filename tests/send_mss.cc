@@ -0,0 +1,141 @@
+#include "congestion_control.hh"
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.mss = 500;
+      cfg.congestion = CongestionControl::Algorithm::Reno;
+
+      TCPSenderTestHarness test { "Configured MSS", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { 2000 } ); // four segments of the smaller size
+
+      test.execute( Push { string( 5000, 'a' ) } );
+      for ( uint32_t i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 500 ).with_seqno( isn + 1 + 500 * i ) );
+      }
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.congestion = CongestionControl::Algorithm::Reno;
+
+      TCPSenderTestHarness test { "Peer's MSS option lowers the MSS", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( SetPeerMSS { 536 } );
+      test.execute( ExpectMSS { 536 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { 2144 } );
+
+      test.execute( Push { string( 3000, 'b' ) } );
+      for ( uint32_t i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 536 ).with_seqno( isn + 1 + 536 * i ) );
+      }
+      test.execute( ExpectNoSegment {} );
+
+      // once the handshake is over, a stray SYN can't change it
+      test.execute( SetPeerMSS { 100 } );
+      test.execute( ExpectMSS { 536 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "Peer's MSS option doesn't raise the MSS", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( SetPeerMSS { 9000 } );
+      test.execute( ExpectMSS { TCPConfig::MAX_PAYLOAD_SIZE } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 5000 ) );
+      test.execute( Push { string( 2000, 'c' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( TCPConfig::MAX_PAYLOAD_SIZE ) );
+      test.execute( ExpectMessage {}.with_payload_size( TCPConfig::MAX_PAYLOAD_SIZE ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.super_segments = true;
+
+      TCPSenderTestHarness test { "Super-segments", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+
+      // the whole window in one message
+      test.execute( Push { string( 20000, 'd' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 20000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 20000 } );
+
+      // the receiver acknowledges the wire segments one at a time
+      test.execute( AckReceived { Wrap32 { isn + 4001 } }.with_win( 60000 ) );
+      test.execute( ExpectSeqnosInFlight { 16000 } );
+      test.execute( ExpectNoSegment {} );
+
+      // and only the rest is retransmitted
+      test.execute( Tick { cfg.rt_timeout - 1U } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_payload_size( 16000 ).with_seqno( isn + 4001 ) );
+      test.execute( ExpectConsecutiveRetransmissions { 1 } );
+
+      test.execute( AckReceived { Wrap32 { isn + 20001 } }.with_win( 60000 ) );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.super_segments = true;
+      cfg.congestion = CongestionControl::Algorithm::Reno;
+
+      TCPSenderTestHarness test { "Super-segments within the congestion window", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 20000, 'e' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 4000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // each acknowledged wire segment grows the window as usual
+      test.execute( AckReceived { Wrap32 { isn + 1001 } }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { 5000 } );
+      test.execute( ExpectMessage {}.with_payload_size( 2000 ).with_seqno( isn + 4001 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
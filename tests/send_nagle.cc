@@ -0,0 +1,101 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "Without Nagle, every write goes at once", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 10000 ) );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( Push { "def" } );
+      test.execute( ExpectMessage {}.with_data( "def" ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.nagle = true;
+
+      TCPSenderTestHarness test { "Nagle", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 10000 ) );
+
+      // with nothing in flight, a short segment goes at once...
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_seqno( isn + 1 ) );
+
+      // ... but the next ones wait for its ACK
+      test.execute( Push { "def" } );
+      test.execute( Push { "ghi" } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 4 } }.with_win( 10000 ) );
+      test.execute( ExpectMessage {}.with_data( "defghi" ).with_seqno( isn + 4 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // full-sized segments always go, leaving the short tail behind
+      test.execute( Push { string( 2500, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 10 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1010 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 2010 } }.with_win( 10000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 500 ).with_seqno( isn + 2010 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // closing the stream sends the short tail with the FIN
+      test.execute( Push { "jk" }.with_close() );
+      test.execute( ExpectMessage {}.with_data( "jk" ).with_fin( true ).with_seqno( isn + 2510 ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "Cork", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 10000 ) );
+      test.execute( Cork {} );
+
+      // even with nothing in flight, short writes are held back until a full segment builds up
+      for ( uint32_t i = 0; i < 9; ++i ) {
+        test.execute( Push { string( 100, 'a' ) } );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( Push { string( 150, 'b' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+
+      test.execute( Uncork {} );
+      test.execute( ExpectMessage {}.with_payload_size( 50 ).with_seqno( isn + 1001 ) );
+      test.execute( Push { "c" } );
+      test.execute( ExpectMessage {}.with_data( "c" ) );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,103 @@
+#include "congestion_control.hh"
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "No pacing", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 5000 ) );
+      test.execute( Push { string( 3000, 'a' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      test.execute( ExpectNextTransmit { nullopt } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.pacing = true;
+      cfg.pacing_rate = 100000; // 100 bytes per ms
+
+      TCPSenderTestHarness test { "Configured pacing rate", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( ExpectNextTransmit { nullopt } ); // nothing to send
+
+      test.execute( Push { string( 3000, 'b' ) } );
+      test.execute( ExpectNoSegment {} ); // the SYN used up the allowance
+      test.execute( ExpectNextTransmit { 1 } );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // one segment every 10 ms
+      test.execute( ExpectNextTransmit { 10 } );
+      test.execute( Tick { 9 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // an idle period allows a burst of at most two segments
+      test.execute( Tick { 500 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 2001 ) );
+      test.execute( Push { string( 3000, 'c' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 3001 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.pacing = true;
+      cfg.adaptive_rto = true;
+      cfg.congestion = CongestionControl::Algorithm::Reno;
+
+      TCPSenderTestHarness test { "Pacing rate from cwnd / SRTT", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( ExpectSRTT { 100.0 } );
+
+      // slow start: twice cwnd (4000) per SRTT, 80 bytes per ms
+      test.execute( Push { string( 4000, 'd' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectNextTransmit { 13 } );
+      test.execute( Tick { 12 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
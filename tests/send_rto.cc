@@ -0,0 +1,180 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "Fixed RTO unless adaptive RTO is enabled", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( Tick { 10 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      test.execute( ExpectSRTT { nullopt } );
+      test.execute( ExpectRTO { cfg.rt_timeout } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.adaptive_rto = true;
+      cfg.min_RTO_ms = 10;
+
+      TCPSenderTestHarness test { "RTO follows the measured RTT", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( ExpectRTO { cfg.rt_timeout } );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+
+      // first sample: SRTT = R, RTTVAR = R/2, RTO = SRTT + 4 * RTTVAR
+      test.execute( ExpectSRTT { 100 } );
+      test.execute( ExpectRTO { 300 } );
+
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( Tick { 20 } );
+      test.execute( AckReceived { Wrap32 { isn + 4 } } );
+      test.execute( ExpectSRTT { 90 } );  // 7/8 * 100 + 1/8 * 20
+      test.execute( ExpectRTO { 320 } ); // RTTVAR = 3/4 * 50 + 1/4 * 80 = 57.5
+
+      // only the first segment in flight is timed
+      test.execute( Push { "def" } );
+      test.execute( Tick { 10 } );
+      test.execute( Push { "ghi" } );
+      test.execute( ExpectMessage {}.with_data( "def" ) );
+      test.execute( ExpectMessage {}.with_data( "ghi" ) );
+      test.execute( Tick { 10 } );
+      test.execute( AckReceived { Wrap32 { isn + 7 } } );
+      test.execute( ExpectSRTT { 81.25 } );
+      test.execute( AckReceived { Wrap32 { isn + 10 } } );
+      test.execute( ExpectSRTT { 81.25 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.adaptive_rto = true;
+      cfg.min_RTO_ms = 10;
+
+      TCPSenderTestHarness test { "Karn's rule: no sample from a retransmitted segment", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      test.execute( ExpectRTO { 300 } );
+
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( Tick { 299 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( ExpectRTO { 600 } );
+      test.execute( Tick { 5 } );
+      test.execute( AckReceived { Wrap32 { isn + 4 } } );
+      test.execute( ExpectSRTT { 100 } );
+      test.execute( ExpectRTO { 300 } ); // the backoff is undone, but the estimate is unchanged
+
+      // the next segment is timed again
+      test.execute( Push { "def" } );
+      test.execute( ExpectMessage {}.with_data( "def" ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 7 } } );
+      test.execute( ExpectSRTT { 100 } );
+      test.execute( ExpectRTO { 250 } ); // RTTVAR = 3/4 * 50
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.adaptive_rto = true;
+      cfg.min_RTO_ms = 500;
+      cfg.max_RTO_ms = 1500;
+
+      TCPSenderTestHarness test { "RTO is clamped, backoff included", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( Tick { 1 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      test.execute( ExpectSRTT { 1 } );
+      test.execute( ExpectRTO { 500 } );
+
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( Tick { 500 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( ExpectRTO { 1000 } );
+      test.execute( Tick { 1000 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( ExpectRTO { 1500 } );
+      test.execute( Tick { 1500 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( ExpectRTO { 1500 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.adaptive_rto = true;
+      cfg.min_RTO_ms = 10;
+      cfg.timestamps = true;
+
+      TCPSenderTestHarness test { "Timestamps time every segment, retransmissions included", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_TSval( 0 ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_TSecr( 0 ) );
+      test.execute( ExpectSRTT { 100 } );
+
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_TSval( 100 ) );
+      test.execute( Tick { 10 } );
+      test.execute( Push { "def" } );
+      test.execute( ExpectMessage {}.with_data( "def" ).with_TSval( 110 ) );
+      test.execute( Tick { 10 } );
+      test.execute( AckReceived { Wrap32 { isn + 4 } }.with_TSecr( 100 ) );
+      test.execute( ExpectSRTT { 90 } ); // 7/8 * 100 + 1/8 * 20
+      test.execute( AckReceived { Wrap32 { isn + 7 } }.with_TSecr( 110 ) );
+      test.execute( ExpectSRTT { 80 } ); // 7/8 * 90 + 1/8 * 10
+      test.execute( ExpectRTO { 333 } ); // RTTVAR = 3/4 * (3/4 * 50 + 1/4 * 80) + 1/4 * 80
+
+      // the echo says which transmission is being acknowledged, so Karn's rule isn't needed
+      test.execute( Push { "ghi" } );
+      test.execute( ExpectMessage {}.with_data( "ghi" ).with_TSval( 120 ) );
+      test.execute( Tick { 333 } );
+      test.execute( ExpectMessage {}.with_data( "ghi" ).with_TSval( 453 ) );
+      test.execute( Tick { 7 } );
+      test.execute( AckReceived { Wrap32 { isn + 10 } }.with_TSecr( 453 ) );
+      test.execute( ExpectSRTT { 70.875 } ); // 7/8 * 80 + 1/8 * 7
+
+      // no sample from an ACK without an echo, or one of nothing new
+      test.execute( AckReceived { Wrap32 { isn + 10 } }.with_TSecr( 0 ) );
+      test.execute( ExpectSRTT { 70.875 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
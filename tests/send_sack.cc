@@ -0,0 +1,116 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.fast_retransmit = true;
+
+      TCPSenderTestHarness test { "SACK blocks show exactly which segments to resend", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      for ( const char* data : { "a", "b", "c", "d", "e", "f", "g", "h" } ) {
+        test.execute( Push { data } );
+        test.execute( ExpectMessage {}.with_data( data ) );
+      }
+
+      // "b" and "d" are lost
+      const auto dup_ack = [&] { return AckReceived { Wrap32 { isn + 2 } }; };
+      test.execute( AckReceived { Wrap32 { isn + 2 } } );
+      test.execute( dup_ack().with_sack( isn + 3, isn + 4 ) );
+      test.execute( dup_ack().with_sack( isn + 3, isn + 4 ).with_sack( isn + 5, isn + 6 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( dup_ack().with_sack( isn + 3, isn + 4 ).with_sack( isn + 5, isn + 7 ) );
+      test.execute( ExpectMessage {}.with_data( "b" ).with_seqno( isn + 2 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectInFastRecovery { true } );
+
+      // three SACKed segments above "d" mark it lost too, without waiting for a partial ACK
+      test.execute( dup_ack().with_sack( isn + 3, isn + 4 ).with_sack( isn + 5, isn + 8 ) );
+      test.execute( ExpectMessage {}.with_data( "d" ).with_seqno( isn + 4 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // "d" was already resent, so the partial ACK doesn't resend it again
+      test.execute( AckReceived { Wrap32 { isn + 4 } }.with_sack( isn + 5, isn + 8 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 9 } } );
+      test.execute( ExpectInFastRecovery { false } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( ExpectFastRetransmissions { 2 } );
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.fast_retransmit = true;
+
+      TCPSenderTestHarness test { "Blocks that don't cover a whole segment are ignored", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      for ( const char* data : { "aa", "bb", "cc", "dd", "ee" } ) {
+        test.execute( Push { data } );
+        test.execute( ExpectMessage {}.with_data( data ) );
+      }
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 100 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 100 ).with_sack( isn + 4, isn + 6 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 100 ).with_sack( isn + 4, isn + 8 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // a block beyond anything sent is ignored too
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 100 ).with_sack( isn + 20, isn + 30 ) );
+      test.execute( ExpectMessage {}.with_data( "aa" ) ); // (the third duplicate ACK)
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectFastRetransmissions { 1 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.fast_retransmit = true;
+
+      TCPSenderTestHarness test { "Large scoreboard", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      const uint32_t segments = 20000;
+      for ( uint32_t i = 0; i < segments; ++i ) {
+        test.execute( Push { "x" } );
+      }
+      test.execute( ExpectSeqnosInFlight { segments } );
+
+      // every tenth segment lost
+      Receive sacks { AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) };
+      for ( uint32_t i = 1; i < segments; i += 10 ) {
+        sacks.with_sack( isn + 1 + i, isn + 1 + i + 9 );
+      }
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( sacks );
+      test.execute( ExpectFastRetransmissions { segments / 10 } );
+      test.execute( ExpectInFastRecovery { true } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
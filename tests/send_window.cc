@@ -140,6 +140,24 @@ int main()
       test.execute( ExpectMessage {}.with_fin( true ).with_data( "4567" ) );
       test.execute( ExpectNoSegment {} );
     }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.send_capacity = 300'000;
+
+      TCPSenderTestHarness test { "Window beyond 64 KiB (with window scaling)", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 200'000 ) );
+      test.execute( Push { string( 250'000, 'w' ) } );
+      for ( uint32_t i = 0; i < 200; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 1000 * i ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 200'000 } );
+    }
   } catch ( const exception& e ) {
     cerr << e.what() << endl;
     return 1;
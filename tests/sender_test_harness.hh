@@ -80,6 +80,74 @@ struct ExpectConsecutiveRetransmissions : public ExpectNumber<SenderAndOutput, u
   uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.consecutive_retransmissions(); }
 };
 
+struct ExpectCongestionWindow : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "congestion window"; }
+  uint64_t value( SenderAndOutput& ss ) const override
+  {
+    if ( not ss.sender.congestion_control() ) {
+      throw ExpectationViolation( "TCPSender has no congestion control" );
+    }
+    return ss.sender.congestion_control()->cwnd();
+  }
+};
+
+struct ExpectSlowStartThreshold : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "slow-start threshold"; }
+  uint64_t value( SenderAndOutput& ss ) const override
+  {
+    if ( not ss.sender.congestion_control() ) {
+      throw ExpectationViolation( "TCPSender has no congestion control" );
+    }
+    return ss.sender.congestion_control()->ssthresh();
+  }
+};
+
+struct ExpectRTO : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "RTO_ms"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.RTO_ms(); }
+};
+
+struct ExpectSRTT : public ExpectNumber<SenderAndOutput, std::optional<double>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "srtt_ms"; }
+  std::optional<double> value( SenderAndOutput& ss ) const override { return ss.sender.srtt_ms(); }
+};
+
+struct ExpectFastRetransmissions : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "fast_retransmissions"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.fast_retransmissions(); }
+};
+
+struct ExpectInFastRecovery : public ExpectBool<SenderAndOutput>
+{
+  using ExpectBool::ExpectBool;
+  std::string name() const override { return "in_fast_recovery"; }
+  bool value( SenderAndOutput& ss ) const override { return ss.sender.in_fast_recovery(); }
+};
+
+struct ExpectNextTransmit : public ExpectNumber<SenderAndOutput, std::optional<uint64_t>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "next_transmit_ms"; }
+  std::optional<uint64_t> value( SenderAndOutput& ss ) const override { return ss.sender.next_transmit_ms(); }
+};
+
+struct ExpectMSS : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "mss"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.mss(); }
+};
+
 struct ExpectNoSegment : public Expectation<SenderAndOutput>
 {
   std::string description() const override { return "nothing to send"; }
@@ -97,6 +165,27 @@ struct SetError : public Action<SenderAndOutput>
   void execute( SenderAndOutput& ss ) const override { ss.sender.writer().set_error(); }
 };
 
+struct SetPeerMSS : public Action<SenderAndOutput>
+{
+  uint16_t mss_;
+
+  explicit SetPeerMSS( uint16_t mss ) : mss_( mss ) {}
+  std::string description() const override { return "peer's MSS option is " + std::to_string( mss_ ); }
+  void execute( SenderAndOutput& ss ) const override { ss.sender.set_peer_mss( mss_ ); }
+};
+
+struct Cork : public Action<SenderAndOutput>
+{
+  std::string description() const override { return "cork"; }
+  void execute( SenderAndOutput& ss ) const override { ss.sender.cork(); }
+};
+
+struct Uncork : public Action<SenderAndOutput>
+{
+  std::string description() const override { return "uncork"; }
+  void execute( SenderAndOutput& ss ) const override { ss.sender.uncork( ss.make_transmit() ); }
+};
+
 struct HasError : public ExpectBool<SenderAndOutput>
 {
   using ExpectBool::ExpectBool;
@@ -192,19 +281,38 @@ struct Receive : public Action<SenderAndOutput>
   std::string description() const override
   {
     std::ostringstream desc;
-    desc << "receive(ack=" << to_string( msg_.ackno ) << ", win=" << msg_.window_size << ")";
+    desc << "receive(ack=" << to_string( msg_.ackno ) << ", win=" << msg_.window_size;
+    for ( const auto& [left, right] : msg_.sack ) {
+      desc << ", sack=[" << to_string( left ) << ", " << to_string( right ) << ")";
+    }
+    if ( msg_.TSecr ) {
+      desc << ", TSecr=" << *msg_.TSecr;
+    }
+    desc << ")";
     if ( push_ ) {
       desc << ", then push stream to TCPSender";
     }
     return desc.str();
   }
 
-  Receive& with_win( uint16_t win )
+  Receive& with_win( uint32_t win )
   {
     msg_.window_size = win;
     return *this;
   }
 
+  Receive& with_sack( Wrap32 left, Wrap32 right )
+  {
+    msg_.sack.push_back( { left, right } );
+    return *this;
+  }
+
+  Receive& with_TSecr( uint32_t echo )
+  {
+    msg_.TSecr = echo;
+    return *this;
+  }
+
   void execute( SenderAndOutput& ss ) const override
   {
     ss.sender.receive( msg_ );
@@ -238,6 +346,7 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
   std::optional<Wrap32> seqno {};
   std::optional<std::string> data {};
   std::optional<size_t> payload_size {};
+  std::optional<std::optional<uint32_t>> TSval {};
 
   ExpectMessage& with_syn( bool syn_ )
   {
@@ -283,6 +392,12 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
     return *this;
   }
 
+  ExpectMessage& with_TSval( std::optional<uint32_t> TSval_ )
+  {
+    TSval = TSval_;
+    return *this;
+  }
+
   std::string message_description() const
   {
     std::ostringstream o;
@@ -308,6 +423,9 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
     if ( rst.has_value() ) {
       o << ( rst.value() ? " +RST" : " (no RST)" );
     }
+    if ( TSval.has_value() ) {
+      o << " TSval=" << to_string( TSval.value() );
+    }
     return o.str();
   }
 
@@ -337,10 +455,13 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
     if ( seqno.has_value() and seg.seqno != seqno.value() ) {
       throw ExpectationViolation( "sequence number", seqno.value(), seg.seqno );
     }
+    if ( TSval.has_value() and seg.TSval != TSval.value() ) {
+      throw ExpectationViolation( "TSval", TSval.value(), seg.TSval );
+    }
     if ( payload_size.has_value() and seg.payload.size() != payload_size.value() ) {
       throw ExpectationViolation( "payload_size", payload_size.value(), seg.payload.size() );
     }
-    if ( seg.payload.size() > TCPConfig::MAX_PAYLOAD_SIZE ) {
+    if ( seg.payload.size() > ss.sender.max_payload_size() ) {
       throw ExpectationViolation( "payload has length (" + std::to_string( seg.payload.size() )
                                   + ") greater than the maximum" );
     }
@@ -355,10 +476,16 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
 
 class TCPSenderTestHarness : public TestHarness<SenderAndOutput>
 {
+  static std::string congestion_description( const TCPConfig& config )
+  {
+    const auto cc = CongestionControl::make( config.congestion, config.mss );
+    return cc ? ", congestion_control=" + std::string { cc->name() } : "";
+  }
+
 public:
   TCPSenderTestHarness( std::string name, TCPConfig config )
     : TestHarness( move( name ),
-                   "initial_RTO_ms=" + to_string( config.rt_timeout ),
-                   { TCPSender { ByteStream { config.send_capacity }, config.isn, config.rt_timeout } } )
+                   "initial_RTO_ms=" + to_string( config.rt_timeout ) + congestion_description( config ),
+                   { TCPSender { ByteStream { config.send_capacity }, config } } )
   {}
 };
@@ -0,0 +1,333 @@
+#include "checksum.hh"
+#include "ipv4_header.hh"
+#include "parser.hh"
+#include "tcp_segment.hh"
+#include "test_should_be.hh"
+
+#include <array>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+constexpr uint32_t pseudo_checksum = 0x1234;
+
+TCPSegment roundtrip( TCPSegment seg )
+{
+  seg.compute_checksum( pseudo_checksum );
+  Serializer serializer;
+  seg.serialize( serializer );
+  const vector<string> wire = serializer.output();
+
+  size_t wire_length = 0;
+  for ( const auto& s : wire ) {
+    wire_length += s.size();
+  }
+  test_should_be( wire_length, seg.header_length() + seg.message.sender.payload.size() );
+
+  TCPSegment out;
+  Parser parser { wire };
+  out.parse( parser, pseudo_checksum );
+  test_should_be( parser.has_error(), false );
+
+  // the contiguous parser reads the same segment
+  string contiguous;
+  for ( const auto& s : wire ) {
+    contiguous += s;
+  }
+  TCPSegment flat;
+  SpanParser span_parser { contiguous };
+  flat.parse( span_parser, pseudo_checksum );
+  test_should_be( span_parser.has_error(), false );
+  test_should_be( serialize( flat ) == serialize( out ), true );
+
+  // and rejects it cut short
+  for ( const size_t len : { size_t { 3 }, seg.header_length() - 1 } ) {
+    TCPSegment truncated;
+    SpanParser short_parser { string_view { contiguous }.substr( 0, len ) };
+    truncated.parse( short_parser, pseudo_checksum );
+    test_should_be( short_parser.has_error(), true );
+  }
+  return out;
+}
+
+// Fill in the checksum field of a hand-built segment
+string with_checksum( string segment )
+{
+  InternetChecksum check { pseudo_checksum };
+  check.add( segment );
+  const uint16_t cksum = check.value();
+  segment[16] = static_cast<char>( cksum >> 8 );
+  segment[17] = static_cast<char>( cksum & 0xff );
+  return segment;
+}
+} // namespace
+
+int main()
+{
+  try {
+    {
+      // no options: a plain 20-byte header
+      TCPSegment seg;
+      seg.message.sender.seqno = Wrap32 { 1000 };
+      seg.message.sender.payload = string { "hello" };
+      seg.message.receiver.ackno = Wrap32 { 77 };
+      seg.message.receiver.window_size = 5000;
+      test_should_be( seg.header_length(), size_t { 20 } );
+
+      const TCPSegment out = roundtrip( seg );
+      test_should_be( out.message.sender.seqno == Wrap32 { 1000 }, true );
+      test_should_be( out.message.sender.payload.view() == "hello", true );
+      test_should_be( out.message.receiver.window_size, uint32_t { 5000 } );
+      test_should_be( out.message.sender.sack_permitted, false );
+      test_should_be( out.message.receiver.sack.empty(), true );
+    }
+
+    {
+      // SACK-permitted is only sent on a SYN
+      TCPSegment seg;
+      seg.message.sender.sack_permitted = true;
+      test_should_be( seg.header_length(), size_t { 20 } );
+      seg.message.sender.SYN = true;
+      test_should_be( seg.header_length(), size_t { 24 } );
+
+      const TCPSegment out = roundtrip( seg );
+      test_should_be( out.message.sender.SYN, true );
+      test_should_be( out.message.sender.sack_permitted, true );
+    }
+
+    {
+      // the MSS option, also only on a SYN
+      TCPSegment seg;
+      seg.message.sender.mss = 1460;
+      test_should_be( seg.header_length(), size_t { 20 } );
+      seg.message.sender.SYN = true;
+      seg.message.sender.sack_permitted = true;
+      test_should_be( seg.header_length(), size_t { 28 } );
+
+      const TCPSegment out = roundtrip( seg );
+      test_should_be( out.message.sender.mss, uint16_t { 1460 } );
+      test_should_be( out.message.sender.sack_permitted, true );
+    }
+
+    {
+      // the window-scale option on a SYN; later windows go out shifted
+      TCPSegment seg;
+      seg.message.sender.SYN = true;
+      seg.message.sender.window_scale = 7;
+      test_should_be( seg.header_length(), size_t { 24 } );
+      test_should_be( roundtrip( seg ).message.sender.window_scale == optional<uint8_t> { 7 }, true );
+
+      seg.message.sender.SYN = false;
+      seg.message.receiver.window_size = 1'000'000;
+      seg.message.receiver.window_shift = 7;
+      test_should_be( seg.header_length(), size_t { 20 } );
+      const TCPSegment out = roundtrip( seg );
+      test_should_be( out.message.receiver.window_size, uint32_t { 1'000'000 >> 7 } );
+      test_should_be( out.message.sender.window_scale.has_value(), false );
+    }
+
+    {
+      // a super-segment is split into wire-sized segments that share its payload
+      TCPMessage msg;
+      msg.sender.seqno = Wrap32 { 100 };
+      msg.sender.SYN = true;
+      msg.sender.payload = string { "abcdefghij" };
+      msg.sender.FIN = true;
+      msg.sender.mss = 4;
+      msg.receiver.ackno = Wrap32 { 7 };
+      msg.segment_size = 4;
+
+      vector<TCPMessage> pieces;
+      split_segments( msg, [&]( const TCPMessage& piece ) { pieces.push_back( piece ); } );
+      test_should_be( pieces.size(), size_t { 3 } );
+      test_should_be( pieces[0].sender.seqno == Wrap32 { 100 }, true );
+      test_should_be( pieces[1].sender.seqno == Wrap32 { 105 }, true );
+      test_should_be( pieces[2].sender.seqno == Wrap32 { 109 }, true );
+      test_should_be( pieces[0].sender.payload.view() == "abcd", true );
+      test_should_be( pieces[1].sender.payload.view() == "efgh", true );
+      test_should_be( pieces[2].sender.payload.view() == "ij", true );
+      test_should_be( pieces[0].sender.SYN and not pieces[1].sender.SYN and not pieces[2].sender.SYN, true );
+      test_should_be( not pieces[0].sender.FIN and not pieces[1].sender.FIN and pieces[2].sender.FIN, true );
+      test_should_be( pieces[0].sender.mss, uint16_t { 4 } );
+      test_should_be( pieces[2].sender.mss, uint16_t { 0 } );
+      test_should_be( pieces[1].receiver.ackno == Wrap32 { 7 }, true );
+      test_should_be( pieces[1].segment_size, size_t { 0 } );
+
+      // an ordinary message goes out as is
+      msg.segment_size = 0;
+      pieces.clear();
+      split_segments( msg, [&]( const TCPMessage& piece ) { pieces.push_back( piece ); } );
+      test_should_be( pieces.size(), size_t { 1 } );
+      test_should_be( pieces[0].sender.sequence_length(), size_t { 12 } );
+    }
+
+    {
+      // timestamps; the echo is only read with an ACK
+      TCPSegment seg;
+      seg.message.sender.TSval = 0x1234'5678;
+      seg.message.receiver.TSecr = 0x9abc'def0;
+      test_should_be( seg.header_length(), size_t { 32 } );
+      test_should_be( roundtrip( seg ).message.receiver.TSecr.has_value(), false );
+
+      seg.message.receiver.ackno = Wrap32 { 1 };
+      const TCPSegment out = roundtrip( seg );
+      test_should_be( out.message.sender.TSval == optional<uint32_t> { 0x1234'5678 }, true );
+      test_should_be( out.message.receiver.TSecr == optional<uint32_t> { 0x9abc'def0 }, true );
+
+      // alongside timestamps, only three SACK blocks fit
+      for ( uint32_t i = 0; i < TCPReceiverMessage::MAX_SACK_BLOCKS; ++i ) {
+        seg.message.receiver.sack.push_back( { Wrap32 { 100 * i + 10 }, Wrap32 { 100 * i + 20 } } );
+      }
+      test_should_be( seg.header_length(), size_t { 60 } );
+      test_should_be( roundtrip( seg ).message.receiver.sack.size(), size_t { 3 } );
+    }
+
+    {
+      // SACK blocks, capped at MAX_SACK_BLOCKS
+      TCPSegment seg;
+      seg.message.receiver.ackno = Wrap32 { 1 };
+      for ( uint32_t i = 0; i < TCPReceiverMessage::MAX_SACK_BLOCKS + 2; ++i ) {
+        seg.message.receiver.sack.push_back( { Wrap32 { 100 * i + 10 }, Wrap32 { 100 * i + 20 } } );
+      }
+      test_should_be( seg.header_length(), size_t { 20 + 4 + 8 * TCPReceiverMessage::MAX_SACK_BLOCKS } );
+
+      const TCPSegment out = roundtrip( seg );
+      test_should_be( out.message.receiver.sack.size(), TCPReceiverMessage::MAX_SACK_BLOCKS );
+      for ( uint32_t i = 0; i < TCPReceiverMessage::MAX_SACK_BLOCKS; ++i ) {
+        test_should_be( out.message.receiver.sack[i].left == Wrap32 { 100 * i + 10 }, true );
+        test_should_be( out.message.receiver.sack[i].right == Wrap32 { 100 * i + 20 }, true );
+      }
+    }
+
+    {
+      // unknown options are skipped, and a malformed option length is an error
+      const string header { "\x00\x01\x00\x02"          // ports
+                            "\x00\x00\x00\x05"          // seqno
+                            "\x00\x00\x00\x00"          // ackno
+                            "\x70\x00\x01\x00"          // data offset 7, no flags, window 256
+                            "\x00\x00\x00\x00"          // checksum, urgent pointer
+                            "\x1e\x06\x00\x00\x00\x01"  // an option we don't know
+                            "\x01\x00",                 // NOP, end of options
+                            28 };
+      TCPSegment good;
+      Parser good_parser { vector<string> { with_checksum( header + "payload" ) } };
+      good.parse( good_parser, pseudo_checksum );
+      test_should_be( good_parser.has_error(), false );
+      test_should_be( good.message.sender.seqno == Wrap32 { 5 }, true );
+      test_should_be( good.message.receiver.window_size, uint32_t { 256 } );
+      test_should_be( good.message.sender.payload.view() == "payload", true );
+
+      string bad = header;
+      bad[21] = '\x0f'; // option length runs past the header
+      TCPSegment broken;
+      Parser bad_parser { vector<string> { with_checksum( bad + "payload" ) } };
+      broken.parse( bad_parser, pseudo_checksum );
+      test_should_be( bad_parser.has_error(), true );
+    }
+
+    {
+      // the fused header writer matches compute_checksum() and serialize(), and leaves the payload where it is
+      TCPSegment seg;
+      seg.udinfo.src_port = 1234;
+      seg.udinfo.dst_port = 80;
+      seg.message.sender.seqno = Wrap32 { 99 };
+      seg.message.sender.SYN = true;
+      seg.message.sender.mss = 1460;
+      seg.message.sender.TSval = 7;
+      seg.message.sender.payload = string( 1001, 'x' );
+      seg.message.receiver.ackno = Wrap32 { 3 };
+      seg.message.receiver.window_size = 4000;
+
+      array<char, TCPSegment::MAX_HEADER_LENGTH> header {};
+      const size_t len = seg.serialize_header( header, pseudo_checksum );
+      test_should_be( len, seg.header_length() );
+      const uint16_t fused_cksum = seg.udinfo.cksum;
+
+      TCPSegment reference = seg;
+      reference.compute_checksum( pseudo_checksum );
+      test_should_be( fused_cksum, reference.udinfo.cksum );
+      Serializer serializer;
+      reference.serialize( serializer );
+      string wire;
+      for ( const auto& piece : serializer.output() ) {
+        wire += piece;
+      }
+      test_should_be( string( header.data(), len ) + string { seg.message.sender.payload.view() } == wire, true );
+
+      array<char, 20> too_small {};
+      bool threw = false;
+      try {
+        seg.serialize_header( too_small, pseudo_checksum );
+      } catch ( const runtime_error& ) {
+        threw = true;
+      }
+      test_should_be( threw, true );
+    }
+
+    {
+      // a FixedSerializer gathers an IPv4 header, a TCP header and the payload, which it doesn't copy
+      IPv4Header ip;
+      ip.src = 0x0a000001;
+      ip.dst = 0x0a000002;
+      TCPSegment seg;
+      seg.udinfo.src_port = 1234;
+      seg.udinfo.dst_port = 80;
+      seg.message.sender.seqno = Wrap32 { 5 };
+      seg.message.sender.TSval = 11;
+      seg.message.sender.payload = string( 700, 'y' );
+      seg.message.receiver.ackno = Wrap32 { 17 };
+      ip.len = IPv4Header::LENGTH + seg.header_length() + seg.message.sender.payload.size();
+      ip.compute_checksum();
+
+      array<char, IPv4Header::LENGTH + TCPSegment::MAX_HEADER_LENGTH> headers {};
+      FixedSerializer fixed { headers };
+      ip.serialize( fixed );
+      seg.serialize( fixed, ip.pseudo_checksum() );
+      const auto pieces = fixed.output();
+      test_should_be( pieces.size(), size_t { 2 } );
+      test_should_be( pieces[0].size(), IPv4Header::LENGTH + seg.header_length() );
+      test_should_be( pieces[1].data() == seg.message.sender.payload.view().data(), true );
+
+      TCPSegment reference = seg;
+      reference.compute_checksum( ip.pseudo_checksum() );
+      test_should_be( seg.udinfo.cksum, reference.udinfo.cksum );
+      string expected;
+      for ( const auto& piece : serialize( ip ) ) {
+        expected += piece;
+      }
+      for ( const auto& piece : serialize( reference ) ) {
+        expected += piece;
+      }
+      string gathered;
+      for ( const auto piece : pieces ) {
+        gathered += piece;
+      }
+      test_should_be( gathered == expected, true );
+
+      // writing past the end of the buffer throws
+      array<char, 3> tiny {};
+      FixedSerializer small { tiny };
+      small.integer( uint16_t { 1 } );
+      bool threw = false;
+      try {
+        small.integer( uint16_t { 2 } );
+      } catch ( const runtime_error& ) {
+        threw = true;
+      }
+      test_should_be( threw, true );
+      test_should_be( small.position(), size_t { 2 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
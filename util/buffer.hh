@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+/*
+ * Buffer: a reference-counted, immutable string. Copying a Buffer, or taking a substr() of one,
+ * shares the original allocation instead of copying the bytes, so a payload can travel from a
+ * ByteStream into a TCPSenderMessage (and its queued retransmissions) without being copied.
+ */
+class Buffer
+{
+  std::shared_ptr<std::string> storage_ {};
+  size_t offset_ {};
+  size_t length_ {};
+
+public:
+  Buffer() = default;
+
+  // Take ownership of a string (implicit, so a std::string can be used wherever a Buffer is expected)
+  Buffer( std::string str ) // NOLINT(*-explicit-*)
+    : storage_( str.empty() ? nullptr : std::make_shared<std::string>( std::move( str ) ) )
+    , length_( storage_ ? storage_->size() : 0 )
+  {}
+
+  [[nodiscard]] std::string_view view() const
+  {
+    return storage_ ? std::string_view { *storage_ }.substr( offset_, length_ ) : std::string_view {};
+  }
+  operator std::string_view() const { return view(); } // NOLINT(*-explicit-*)
+
+  [[nodiscard]] size_t size() const { return length_; }
+  [[nodiscard]] bool empty() const { return length_ == 0; }
+
+  // A slice of this Buffer that shares its allocation
+  [[nodiscard]] Buffer substr( size_t pos, size_t len = std::string::npos ) const
+  {
+    Buffer ret { *this };
+    ret.remove_prefix( pos );
+    ret.length_ = std::min( len, ret.length_ );
+    return ret;
+  }
+
+  void remove_prefix( size_t n )
+  {
+    n = std::min( n, length_ );
+    offset_ += n;
+    length_ -= n;
+  }
+
+  // Give up this reference, returning the bytes as a string (moved out when this was the only reference)
+  std::string release()
+  {
+    std::string ret;
+    if ( storage_ and storage_.use_count() == 1 and offset_ == 0 and length_ == storage_->size() ) {
+      ret = std::move( *storage_ );
+    } else {
+      ret = view();
+    }
+    *this = {};
+    return ret;
+  }
+
+  // Give up this reference, returning the whole underlying allocation if this was the only reference
+  // (so it can be recycled, e.g. into the BufferPool), or an empty string if it is still shared
+  std::string reclaim()
+  {
+    std::string ret;
+    if ( storage_ and storage_.use_count() == 1 ) {
+      ret = std::move( *storage_ );
+    }
+    *this = {};
+    return ret;
+  }
+};
@@ -0,0 +1,64 @@
+#include "buffer_pool.hh"
+
+#include <bit>
+
+using namespace std;
+
+BufferPool& BufferPool::local()
+{
+  thread_local BufferPool pool;
+  return pool;
+}
+
+string BufferPool::acquire( const size_t size )
+{
+  // round up: every string in class c has capacity of at least 2^c
+  const unsigned log2 = max<unsigned>( MIN_CLASS_LOG2, bit_width( max<size_t>( size, 1 ) - 1 ) );
+
+  string ret;
+  if ( log2 <= MAX_CLASS_LOG2 and not free_.at( log2 - MIN_CLASS_LOG2 ).empty() ) {
+    auto& list = free_.at( log2 - MIN_CLASS_LOG2 );
+    ret = move( list.back() );
+    list.pop_back();
+    stats_.cached_bytes -= ret.capacity();
+    ++stats_.hits;
+  } else {
+    ret.reserve( log2 <= MAX_CLASS_LOG2 ? size_t { 1 } << log2 : size );
+    ++stats_.misses;
+  }
+
+  return ret;
+}
+
+void BufferPool::release( string&& str )
+{
+  const size_t capacity = str.capacity();
+  if ( capacity < size_t { 1 } << MIN_CLASS_LOG2 ) {
+    str.clear(); // nothing worth keeping (e.g. a short string stored inline)
+    return;
+  }
+
+  // round down, so the allocation is big enough for anything acquired from its class
+  const unsigned log2 = bit_width( capacity ) - 1;
+  if ( log2 > MAX_CLASS_LOG2 or free_.at( log2 - MIN_CLASS_LOG2 ).size() >= MAX_FREE_PER_CLASS ) {
+    ++stats_.discarded;
+    str = string {};
+    return;
+  }
+
+  str.clear();
+  free_.at( log2 - MIN_CLASS_LOG2 ).push_back( move( str ) );
+  str = string {};
+  ++stats_.recycled;
+  stats_.cached_bytes += capacity;
+  stats_.high_water_bytes = max( stats_.high_water_bytes, stats_.cached_bytes );
+}
+
+void BufferPool::trim()
+{
+  for ( auto& list : free_ ) {
+    list.clear();
+    list.shrink_to_fit();
+  }
+  stats_.cached_bytes = 0;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * BufferPool: recycles the heap allocations behind std::strings, grouped into power-of-two size classes,
+ * so the per-segment strings made by FileDescriptor::read, the Parser, the Reassembler and ByteStream
+ * don't each cost a malloc/free pair. Each thread has its own pool (BufferPool::local()), so no locking.
+ *
+ * A string may be released on a different thread than it was acquired on; it simply joins that thread's pool.
+ */
+class BufferPool
+{
+public:
+  static constexpr unsigned MIN_CLASS_LOG2 = 6;  // smallest pooled allocation: 64 bytes
+  static constexpr unsigned MAX_CLASS_LOG2 = 16; // largest pooled allocation: 64 KiB
+  static constexpr size_t MAX_FREE_PER_CLASS = 256;
+
+  struct Stats
+  {
+    uint64_t hits {};             // acquire() served from a free list
+    uint64_t misses {};           // acquire() had to allocate
+    uint64_t recycled {};         // release() kept the allocation
+    uint64_t discarded {};        // release() freed the allocation (too small, too big, or class full)
+    uint64_t cached_bytes {};     // capacity currently sitting in the free lists
+    uint64_t high_water_bytes {}; // maximum of cached_bytes
+
+    [[nodiscard]] double hit_rate() const
+    {
+      return hits + misses == 0 ? 0.0 : static_cast<double>( hits ) / static_cast<double>( hits + misses );
+    }
+  };
+
+  // The calling thread's pool
+  static BufferPool& local();
+
+  // An empty string with capacity for at least `size` bytes
+  std::string acquire( size_t size );
+
+  // Give a string's allocation back to the pool (the string is left empty)
+  void release( std::string&& str );
+
+  // Free every cached allocation
+  void trim();
+
+  [[nodiscard]] const Stats& stats() const { return stats_; }
+
+private:
+  static constexpr size_t NUM_CLASSES = MAX_CLASS_LOG2 - MIN_CLASS_LOG2 + 1;
+
+  std::array<std::vector<std::string>, NUM_CLASSES> free_ {};
+  Stats stats_ {};
+};
@@ -0,0 +1,169 @@
+#include "checksum.hh"
+
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+
+#if defined( __x86_64__ )
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// The one's-complement sum doesn't depend on byte order (RFC 1071 section 2), so the wide kernels add the data
+// as native-order words and swap the folded 16-bit result at the end.
+
+namespace {
+
+uint16_t fold( uint64_t sum )
+{
+  while ( sum > 0xffff ) {
+    sum = ( sum >> 16 ) + ( sum & 0xffff );
+  }
+  return static_cast<uint16_t>( sum );
+}
+
+uint64_t add_with_carry( uint64_t sum, uint64_t word )
+{
+  sum += word;
+  return sum + ( sum < word );
+}
+
+// Sum of the native-order words of `data` (of even length), folded to 16 bits
+uint16_t sum_word64( string_view data )
+{
+  uint64_t sum = 0;
+  for ( ; data.size() >= 8; data.remove_prefix( 8 ) ) {
+    uint64_t word {};
+    memcpy( &word, data.data(), 8 );
+    sum = add_with_carry( sum, word );
+  }
+  for ( ; data.size() >= 2; data.remove_prefix( 2 ) ) {
+    uint16_t word {};
+    memcpy( &word, data.data(), 2 );
+    sum = add_with_carry( sum, word );
+  }
+  return fold( sum );
+}
+
+#if defined( __x86_64__ )
+// Each 64-bit lane accumulates 32-bit words, so the lanes can't overflow for any realistic length
+uint16_t sum_sse2( string_view data )
+{
+  const __m128i zero = _mm_setzero_si128();
+  __m128i acc = zero;
+  for ( ; data.size() >= 16; data.remove_prefix( 16 ) ) {
+    const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( data.data() ) );
+    acc = _mm_add_epi64( acc, _mm_unpacklo_epi32( v, zero ) );
+    acc = _mm_add_epi64( acc, _mm_unpackhi_epi32( v, zero ) );
+  }
+  uint64_t lanes[2] {};
+  _mm_storeu_si128( reinterpret_cast<__m128i*>( lanes ), acc );
+  const uint64_t sum = add_with_carry( lanes[0], lanes[1] );
+  return fold( add_with_carry( sum, sum_word64( data ) ) );
+}
+
+__attribute__( ( target( "avx2" ) ) ) uint16_t sum_avx2( string_view data )
+{
+  __m256i acc = _mm256_setzero_si256();
+  for ( ; data.size() >= 32; data.remove_prefix( 32 ) ) {
+    const __m256i v = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( data.data() ) );
+    acc = _mm256_add_epi64( acc, _mm256_cvtepu32_epi64( _mm256_castsi256_si128( v ) ) );
+    acc = _mm256_add_epi64( acc, _mm256_cvtepu32_epi64( _mm256_extracti128_si256( v, 1 ) ) );
+  }
+  uint64_t lanes[4] {};
+  _mm256_storeu_si256( reinterpret_cast<__m256i*>( lanes ), acc );
+  const uint64_t sum = add_with_carry( add_with_carry( lanes[0], lanes[1] ), add_with_carry( lanes[2], lanes[3] ) );
+  return fold( add_with_carry( sum, sum_word64( data ) ) ); // not sum_sse2(), which would pay an AVX-SSE transition
+}
+#endif
+
+InternetChecksum::Kernel fastest_kernel()
+{
+  for ( const auto kernel : { InternetChecksum::Kernel::AVX2, InternetChecksum::Kernel::SSE2 } ) {
+    if ( InternetChecksum::supported( kernel ) ) {
+      return kernel;
+    }
+  }
+  return InternetChecksum::Kernel::Word64;
+}
+
+} // namespace
+
+bool InternetChecksum::supported( const Kernel kernel )
+{
+  switch ( kernel ) {
+    case Kernel::Scalar:
+    case Kernel::Word64:
+      return true;
+#if defined( __x86_64__ )
+    case Kernel::SSE2:
+      return true; // part of x86-64
+    case Kernel::AVX2:
+      return __builtin_cpu_supports( "avx2" );
+#else
+    case Kernel::SSE2:
+    case Kernel::AVX2:
+      return false;
+#endif
+  }
+  return false;
+}
+
+void InternetChecksum::add( string_view data )
+{
+  static const Kernel fastest = fastest_kernel();
+  add( data, fastest );
+}
+
+void InternetChecksum::add( string_view data, const Kernel kernel )
+{
+  if ( kernel == Kernel::Scalar ) {
+    for ( const uint8_t i : data ) {
+      uint16_t val = i;
+      if ( not parity_ ) {
+        val <<= 8;
+      }
+      sum_ += val;
+      parity_ = !parity_;
+    }
+    return;
+  }
+
+  if ( data.empty() ) {
+    return;
+  }
+
+  // finish the word that the previous chunk started
+  if ( parity_ ) {
+    sum_ += static_cast<uint8_t>( data.front() );
+    data.remove_prefix( 1 );
+    parity_ = false;
+  }
+
+  const string_view words = data.substr( 0, data.size() & ~size_t { 1 } );
+  uint16_t sum {};
+  switch ( kernel ) {
+#if defined( __x86_64__ )
+    case Kernel::AVX2:
+      sum = sum_avx2( words );
+      break;
+    case Kernel::SSE2:
+      sum = sum_sse2( words );
+      break;
+#endif
+    default:
+      sum = sum_word64( words );
+      break;
+  }
+  if constexpr ( endian::native == endian::little ) {
+    sum = static_cast<uint16_t>( sum << 8 | sum >> 8 );
+  }
+  sum_ += sum;
+
+  if ( data.size() % 2 ) {
+    sum_ += static_cast<uint16_t>( static_cast<uint8_t>( data.back() ) << 8 );
+    parity_ = true;
+  }
+}
@@ -39,7 +39,8 @@ std::string EthernetHeader::to_string() const
   return ss.str();
 }
 
-void EthernetHeader::parse( Parser& parser )
+template<class ParserT>
+void EthernetHeader::parse( ParserT& parser )
 {
   // read destination address
   for ( auto& b : dst ) {
@@ -55,6 +56,9 @@ void EthernetHeader::parse( Parser& parser )
   parser.integer( type );
 }
 
+template void EthernetHeader::parse( Parser& parser );
+template void EthernetHeader::parse( SpanParser& parser );
+
 void EthernetHeader::serialize( Serializer& serializer ) const
 {
   // write destination address
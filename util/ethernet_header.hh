@@ -29,6 +29,7 @@ struct EthernetHeader
   // Return a string containing a header in human-readable format
   [[nodiscard]] std::string to_string() const;
 
-  void parse( Parser& parser );
+  template<class ParserT> // Parser or SpanParser
+  void parse( ParserT& parser );
   void serialize( Serializer& serializer ) const;
 };
@@ -0,0 +1,25 @@
+#include "eventfd.hh"
+#include "exception.hh"
+
+#include <cstdint>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+using namespace std;
+
+EventFD::EventFD() : FileDescriptor( ::CheckSystemCall( "eventfd", ::eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC ) ) ) {}
+
+void EventFD::notify()
+{
+  const uint64_t one = 1;
+  CheckSystemCall( "write", ::write( fd_num(), &one, sizeof( one ) ) );
+  register_write();
+}
+
+bool EventFD::clear()
+{
+  uint64_t count = 0;
+  const ssize_t bytes_read = CheckSystemCall( "read", ::read( fd_num(), &count, sizeof( count ) ) );
+  register_read();
+  return bytes_read == sizeof( count ) and count != 0;
+}
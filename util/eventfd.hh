@@ -0,0 +1,18 @@
+#pragma once
+
+#include "file_descriptor.hh"
+
+//! A FileDescriptor to a Linux [eventfd](\ref man2::eventfd), used as a doorbell between threads
+class EventFD : public FileDescriptor
+{
+public:
+  //! Create a non-blocking eventfd whose counter starts at zero
+  EventFD();
+
+  //! Increment the counter, making the eventfd readable
+  void notify();
+
+  //! Reset the counter to zero
+  //! \returns `true` if the eventfd had been notified since the last clear()
+  bool clear();
+};
@@ -1,10 +1,14 @@
 #include "file_descriptor.hh"
 
+#include "buffer_pool.hh"
 #include "exception.hh"
 
 #include <algorithm>
+#include <array>
+#include <climits>
 #include <fcntl.h>
 #include <iostream>
+#include <span>
 #include <stdexcept>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -83,6 +87,9 @@ FileDescriptor FileDescriptor::duplicate() const
 void FileDescriptor::read( string& buffer )
 {
   if ( buffer.empty() ) {
+    if ( buffer.capacity() < kReadBufferSize ) {
+      buffer = BufferPool::local().acquire( kReadBufferSize );
+    }
     buffer.resize( kReadBufferSize );
   }
 
@@ -151,9 +158,41 @@ void FileDescriptor::read( vector<string>& buffers )
   }
 }
 
+size_t FileDescriptor::read( span<const span<char>> buffers )
+{
+  const size_t count = min( buffers.size(), static_cast<size_t>( IOV_MAX ) );
+  vector<iovec> iovecs;
+  iovecs.reserve( count );
+  size_t total_size = 0;
+  for ( const auto x : buffers.first( count ) ) {
+    iovecs.push_back( { x.data(), x.size() } );
+    total_size += x.size();
+  }
+
+  const ssize_t bytes_read = ::readv( fd_num(), iovecs.data(), static_cast<int>( iovecs.size() ) );
+  if ( bytes_read < 0 ) {
+    if ( internal_fd_->non_blocking_ and ( errno == EAGAIN or errno == EINPROGRESS ) ) {
+      return 0;
+    }
+    throw unix_error { "read" };
+  }
+
+  register_read();
+
+  if ( bytes_read == 0 and total_size != 0 ) {
+    internal_fd_->eof_ = true;
+  }
+
+  if ( bytes_read > static_cast<ssize_t>( total_size ) ) {
+    throw runtime_error( "read() read more than requested" );
+  }
+
+  return bytes_read;
+}
+
 size_t FileDescriptor::write( string_view buffer )
 {
-  return write( vector<string_view> { buffer } );
+  return write( span { &buffer, 1 } );
 }
 
 size_t FileDescriptor::write( const vector<std::string>& buffers )
@@ -168,12 +207,26 @@ size_t FileDescriptor::write( const vector<std::string>& buffers )
 
 size_t FileDescriptor::write( const vector<string_view>& buffers )
 {
-  vector<iovec> iovecs;
-  iovecs.reserve( buffers.size() );
+  return write( span<const string_view> { buffers } );
+}
+
+size_t FileDescriptor::write( span<const string_view> buffers )
+{
+  // writev() rejects more than IOV_MAX buffers, so submit only the first IOV_MAX; callers handle partial writes
+  const size_t count = min( buffers.size(), static_cast<size_t>( IOV_MAX ) );
+
+  // a few buffers (say, headers and a payload) don't need an allocation
+  array<iovec, SMALL_WRITE_BUFFERS> small_iovecs {};
+  vector<iovec> large_iovecs;
+  if ( count > small_iovecs.size() ) {
+    large_iovecs.resize( count );
+  }
+  const span<iovec> iovecs = large_iovecs.empty() ? span { small_iovecs }.first( count ) : span { large_iovecs };
+
   size_t total_size = 0;
-  for ( const auto x : buffers ) {
-    iovecs.push_back( { const_cast<char*>( x.data() ), x.size() } ); // NOLINT(*-const-cast)
-    total_size += x.size();
+  for ( size_t i = 0; i < count; ++i ) {
+    iovecs[i] = { const_cast<char*>( buffers[i].data() ), buffers[i].size() }; // NOLINT(*-const-cast)
+    total_size += buffers[i].size();
   }
 
   const ssize_t bytes_written  = CheckSystemCall( "writev", ::writev( fd_num(), iovecs.data(), static_cast<int>( iovecs.size() ) ) );
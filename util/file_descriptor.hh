@@ -3,6 +3,8 @@
 #include <cstddef>
 #include <limits>
 #include <memory>
+#include <span>
+#include <string_view>
 #include <vector>
 
 // A reference-counted handle to a file descriptor
@@ -47,6 +49,9 @@ protected:
   // size of buffer to allocate for read()
   static constexpr size_t kReadBufferSize = 16384;
 
+  // write() gathers up to this many buffers without allocating
+  static constexpr size_t SMALL_WRITE_BUFFERS = 8;
+
   void set_eof() { internal_fd_->eof_ = true; }
   void register_read() { ++internal_fd_->read_count_; }   // increment read count
   void register_write() { ++internal_fd_->write_count_; } // increment write count
@@ -64,12 +69,15 @@ public:
   // Read into `buffer`
   void read( std::string& buffer );
   void read( std::vector<std::string>& buffers );
+  // Read (scatter) into caller-owned memory; returns the number of bytes read (0 at EOF or if it would block)
+  size_t read( std::span<const std::span<char>> buffers );
 
   // Attempt to write a buffer
   // returns number of bytes written
   size_t write( std::string_view buffer );
   size_t write( const std::vector<std::string_view>& buffers );
   size_t write( const std::vector<std::string>& buffers );
+  size_t write( std::span<const std::string_view> buffers ); // (gather) without allocating, for a few buffers
 
   // Close the underlying file descriptor
   void close() { internal_fd_->close(); }
@@ -2,12 +2,14 @@
 #include "checksum.hh"
 
 #include <arpa/inet.h>
+#include <array>
 #include <sstream>
 
 using namespace std;
 
 // Parse from string.
-void IPv4Header::parse( Parser& parser )
+template<class ParserT>
+void IPv4Header::parse( ParserT& parser )
 {
   uint8_t first_byte {};
   parser.integer( first_byte );
@@ -51,8 +53,12 @@ void IPv4Header::parse( Parser& parser )
   }
 }
 
+template void IPv4Header::parse( Parser& parser );
+template void IPv4Header::parse( SpanParser& parser );
+
 // Serialize the IPv4Header (does not recompute the checksum)
-void IPv4Header::serialize( Serializer& serializer ) const
+template<class SerializerT>
+void IPv4Header::serialize( SerializerT& serializer ) const
 {
   // consistency checks
   if ( ver != 4 ) {
@@ -77,6 +83,9 @@ void IPv4Header::serialize( Serializer& serializer ) const
   serializer.integer( dst );
 }
 
+template void IPv4Header::serialize( Serializer& serializer ) const;
+template void IPv4Header::serialize( FixedSerializer& serializer ) const;
+
 uint16_t IPv4Header::payload_length() const
 {
   return len - 4 * hlen;
@@ -105,15 +114,24 @@ uint32_t IPv4Header::pseudo_checksum() const
 void IPv4Header::compute_checksum()
 {
   cksum = 0;
-  Serializer s;
+  array<char, LENGTH> header {};
+  FixedSerializer s { header };
   serialize( s );
 
   // calculate checksum -- taken over header only
   InternetChecksum check;
-  check.add( s.output() );
+  check.add( string_view { header.data(), header.size() } );
   cksum = check.value();
 }
 
+void IPv4Header::decrement_ttl()
+{
+  const auto word = [this] { return static_cast<uint16_t>( ttl << 8 | proto ); }; // shares a word with the protocol
+  const uint16_t old_word = word();
+  --ttl;
+  cksum = InternetChecksum::update16( cksum, old_word, word() );
+}
+
 std::string IPv4Header::to_string() const
 {
   stringstream ss {};
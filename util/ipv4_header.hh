@@ -57,9 +57,14 @@ struct IPv4Header
   // Set checksum to correct value
   void compute_checksum();
 
+  // Decrement the TTL (which must be nonzero) when forwarding, updating the checksum incrementally (RFC 1624)
+  void decrement_ttl();
+
   // Return a string containing a header in human-readable format
   [[nodiscard]] std::string to_string() const;
 
-  void parse( Parser& parser );
-  void serialize( Serializer& serializer ) const;
+  template<class ParserT> // Parser or SpanParser
+  void parse( ParserT& parser );
+  template<class SerializerT> // Serializer or FixedSerializer
+  void serialize( SerializerT& serializer ) const;
 };
@@ -1,8 +1,13 @@
 #pragma once
 
+#include "buffer_pool.hh"
+
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <concepts>
 #include <cstdint>
+#include <cstring>
 #include <deque>
 #include <span>
 #include <stdexcept>
@@ -22,7 +27,9 @@ class Parser
     explicit BufferList( const std::vector<std::string>& buffers )
     {
       for ( const auto& x : buffers ) {
-        append( x );
+        std::string copy { BufferPool::local().acquire( x.size() ) };
+        copy.assign( x );
+        append( std::move( copy ) );
       }
     }
 
@@ -46,6 +53,7 @@ class Parser
         len -= to_pop_now;
         size_ -= to_pop_now;
         if ( skip_ == buffer_.front().size() ) {
+          BufferPool::local().release( std::move( buffer_.front() ) );
           buffer_.pop_front();
           skip_ = 0;
         }
@@ -60,7 +68,7 @@ class Parser
       }
       std::string first_str = std::move( buffer_.front() );
       if ( skip_ ) {
-        first_str = first_str.substr( skip_ );
+        first_str.erase( 0, skip_ ); // in place, keeping the allocation
       }
       out.emplace_back( std::move( first_str ) );
       buffer_.pop_front();
@@ -167,6 +175,82 @@ public:
   std::vector<std::string_view> buffer() const { return input_.buffer(); }
 };
 
+// A Parser over one contiguous buffer (e.g. a datagram just read from the TUN device). Nothing is copied in: each
+// field is one bounds check and one unaligned load, and the rest of the input is available as a string_view.
+class SpanParser
+{
+  std::span<const char> input_;
+  bool error_ {};
+
+  bool check_size( const size_t size )
+  {
+    if ( size > input_.size() ) {
+      error_ = true;
+    }
+    return not error_;
+  }
+
+  template<std::unsigned_integral T>
+  static constexpr T from_big_endian( const T val )
+  {
+    if constexpr ( sizeof( T ) == 1 or std::endian::native == std::endian::big ) {
+      return val;
+    } else if constexpr ( sizeof( T ) == 2 ) {
+      return __builtin_bswap16( val );
+    } else if constexpr ( sizeof( T ) == 4 ) {
+      return __builtin_bswap32( val );
+    } else {
+      static_assert( sizeof( T ) == 8 );
+      return __builtin_bswap64( val );
+    }
+  }
+
+public:
+  explicit SpanParser( std::span<const char> input ) : input_( input ) {}
+
+  bool has_error() const { return error_; }
+  void set_error() { error_ = true; }
+  void remove_prefix( size_t n )
+  {
+    if ( check_size( n ) ) {
+      input_ = input_.subspan( n );
+    }
+  }
+
+  template<std::unsigned_integral T>
+  void integer( T& out )
+  {
+    if ( not check_size( sizeof( T ) ) ) {
+      return;
+    }
+    T raw {};
+    std::memcpy( &raw, input_.data(), sizeof( T ) );
+    out = from_big_endian( raw );
+    input_ = input_.subspan( sizeof( T ) );
+  }
+
+  void string( std::span<char> out )
+  {
+    if ( not check_size( out.size() ) ) {
+      return;
+    }
+    std::copy_n( input_.begin(), out.size(), out.begin() );
+    input_ = input_.subspan( out.size() );
+  }
+
+  void all_remaining( std::string_view& out )
+  {
+    out = buffer();
+    input_ = {};
+  }
+  void all_remaining( std::string& out )
+  {
+    out = buffer();
+    input_ = {};
+  }
+  std::string_view buffer() const { return { input_.data(), input_.size() }; }
+};
+
 class Serializer
 {
   std::vector<std::string> output_ {};
@@ -217,6 +301,73 @@ public:
   }
 };
 
+// Serializes into a caller's fixed-size buffer (e.g. a stack array) without allocating. Payloads passed
+// to buffer() aren't copied: output() lists the header bytes and payload views in order, for a gathering write.
+class FixedSerializer
+{
+public:
+  static constexpr size_t MAX_PIECES = 8;
+
+private:
+  std::span<char> buffer_;
+  size_t pos_ {};
+  size_t flushed_ {}; // bytes of buffer_ already in output_
+  std::array<std::string_view, MAX_PIECES> output_ {};
+  size_t pieces_ {};
+
+  void add_piece( std::string_view piece )
+  {
+    if ( pieces_ == MAX_PIECES ) {
+      throw std::runtime_error( "FixedSerializer: too many pieces" );
+    }
+    output_[pieces_++] = piece;
+  }
+
+public:
+  explicit FixedSerializer( std::span<char> buffer ) : buffer_( buffer ) {}
+
+  template<std::unsigned_integral T>
+  void integer( const T val )
+  {
+    constexpr uint64_t len = sizeof( T );
+    if ( len > buffer_.size() - pos_ ) {
+      throw std::runtime_error( "FixedSerializer: buffer full" );
+    }
+
+    for ( uint64_t i = 0; i < len; ++i ) {
+      buffer_[pos_++] = static_cast<char>( val >> ( ( len - i - 1 ) * 8 ) );
+    }
+  }
+
+  // The caller keeps `buf` alive until the output has been written
+  void buffer( std::string_view buf )
+  {
+    flush();
+    if ( not buf.empty() ) {
+      add_piece( buf );
+    }
+  }
+
+  void flush()
+  {
+    if ( pos_ > flushed_ ) {
+      add_piece( { buffer_.data() + flushed_, pos_ - flushed_ } );
+      flushed_ = pos_;
+    }
+  }
+
+  // The bytes written into the buffer so far, which the caller may patch (e.g. to fill in a checksum)
+  size_t position() const { return pos_; }
+  size_t capacity() const { return buffer_.size(); }
+  std::span<char> written() { return buffer_.first( pos_ ); }
+
+  std::span<const std::string_view> output()
+  {
+    flush();
+    return std::span { output_ }.first( pieces_ );
+  }
+};
+
 // Helper to serialize any object (without constructing a Serializer of the caller's own)
 template<class T>
 std::vector<std::string> serialize( const T& obj )
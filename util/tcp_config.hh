@@ -1,6 +1,7 @@
 #pragma once
 
 #include "address.hh"
+#include "congestion_control.hh"
 #include "wrapping_integers.hh"
 
 #include <cstddef>
@@ -11,15 +12,36 @@
 class TCPConfig
 {
 public:
-  static constexpr size_t DEFAULT_CAPACITY = 64000; //!< Default capacity
-  static constexpr size_t MAX_PAYLOAD_SIZE = 1000;  //!< Conservative max payload size for real Internet
-  static constexpr uint16_t TIMEOUT_DFLT = 1000;    //!< Default re-transmit timeout is 1 second
-  static constexpr unsigned MAX_RETX_ATTEMPTS = 8;  //!< Maximum re-transmit attempts before giving up
+  static constexpr size_t DEFAULT_CAPACITY = 64000;  //!< Default capacity
+  static constexpr size_t MAX_PAYLOAD_SIZE = 1000;   //!< Conservative max payload size for real Internet
+  static constexpr size_t MAX_SUPER_SEGMENT = 64000; //!< Largest payload of a super-segment (cf. TSO's 64 KiB)
+  static constexpr uint16_t TIMEOUT_DFLT = 1000;     //!< Default re-transmit timeout is 1 second
+  static constexpr unsigned MAX_RETX_ATTEMPTS = 8;   //!< Maximum re-transmit attempts before giving up
+  static constexpr unsigned DUP_ACK_THRESHOLD = 3;   //!< Duplicate ACKs that trigger a fast retransmit
+  static constexpr uint64_t RTO_MIN_DFLT = 200;      //!< Default lower bound on an adaptive RTO
+  static constexpr uint64_t RTO_MAX_DFLT = 60000;    //!< Default upper bound on an adaptive RTO
+  static constexpr uint16_t ACK_DELAY_DFLT = 40;     //!< A typical delayed-ACK timer, in milliseconds
 
   uint16_t rt_timeout = TIMEOUT_DFLT;      //!< Initial value of the retransmission timeout, in milliseconds
   size_t recv_capacity = DEFAULT_CAPACITY; //!< Receive capacity, in bytes
   size_t send_capacity = DEFAULT_CAPACITY; //!< Sender capacity, in bytes
   Wrap32 isn { 137 };                      //!< Default initial sequence number
+  bool sack = false;                       //!< Offer SACK (and send SACK blocks if the peer offers it too)
+  bool adaptive_rto = false;               //!< Derive the RTO from measured RTTs (RFC 6298), starting at rt_timeout
+  uint64_t min_RTO_ms = RTO_MIN_DFLT;      //!< Lower bound on the adaptive RTO, in milliseconds
+  uint64_t max_RTO_ms = RTO_MAX_DFLT;      //!< Upper bound on the adaptive RTO (and its backoff), in milliseconds
+  bool fast_retransmit = false;            //!< Resend on the third duplicate ACK, then NewReno fast recovery
+  uint16_t mss = MAX_PAYLOAD_SIZE;         //!< Largest payload per segment; offered in the MSS option on the SYN
+  bool super_segments = false;             //!< Sender emits super-segments for the adapter to split (cf. TSO)
+  bool window_scaling = false;             //!< Offer window scaling (RFC 7323), so windows can exceed 64 KiB
+  bool timestamps = false;                 //!< Offer timestamps (RFC 7323): an RTT sample per ACK, and PAWS
+  uint16_t ack_delay_ms = 0;               //!< Delay ACKs of in-order data by up to this long (0: ACK at once)
+  bool pacing = false;                     //!< Spread each window's segments over the RTT instead of bursting
+  uint64_t pacing_rate = 0;                //!< Pacing rate in bytes/s (0: from cwnd / SRTT once there's an RTT)
+  bool nagle = false;                      //!< Hold back a short segment while data is unacknowledged (RFC 896)
+
+  //! Congestion-control algorithm for the sender
+  CongestionControl::Algorithm congestion = CongestionControl::Algorithm::None;
 };
 
 //! Config for classes derived from FdAdapter
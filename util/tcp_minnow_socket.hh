@@ -2,25 +2,35 @@
 
 #include "byte_stream.hh"
 #include "eventloop.hh"
+#include "exception.hh"
 #include "file_descriptor.hh"
 #include "socket.hh"
+#include "spsc_byte_stream.hh"
 #include "tcp_config.hh"
 #include "tcp_peer.hh"
 #include "tuntap_adapter.hh"
 
 #include <atomic>
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <thread>
 #include <vector>
 
+//! How bytes travel between the owner thread and the TCPPeer thread
+enum class ThreadHandoff : uint8_t
+{
+  SocketPair, //!< through an AF_UNIX socketpair; the owner reads and writes the socket itself
+  SharedRing  //!< through a pair of SPSCByteStreams; the owner uses outbound_ring() and inbound_ring()
+};
+
 //! Multithreaded wrapper around TCPPeer that approximates the Unix sockets API
 template<TCPDatagramAdapter AdaptT>
 class TCPMinnowSocket : public LocalStreamSocket
 {
 public:
   //! Construct from the interface that the TCPPeer thread will use to read and write datagrams
-  explicit TCPMinnowSocket( AdaptT&& datagram_interface );
+  explicit TCPMinnowSocket( AdaptT&& datagram_interface, ThreadHandoff handoff = ThreadHandoff::SocketPair );
 
   //! Close socket, and wait for TCPPeer to finish
   //! \note Calling this function is only advisable if the socket has reached EOF,
@@ -55,9 +65,27 @@ public:
   void set_reuseaddr() = delete;
   //!@}
 
+  //! \name
+  //! Batching small writes (cf. TCP_CORK): while corked, the TCPPeer sends only full-sized segments.
+  //! uncork() releases the rest within one tick of the TCPPeer thread.
+
+  //!@{
+  void cork() { _corked.store( true ); }
+  void uncork() { _corked.store( false ); }
+  //!@}
+
   // Return peer address from underlying datagram adapter
   const Address& peer_address() const { return _datagram_adapter.config().destination; }
 
+  //! \name
+  //! In ThreadHandoff::SharedRing mode, the owner pushes outbound bytes into outbound_ring() and pops
+  //! inbound bytes from inbound_ring(); both are available once connect() or listen_and_accept() returns.
+
+  //!@{
+  SPSCByteStream& outbound_ring() { return *notnull( "outbound_ring", _outbound_ring.get() ); }
+  SPSCByteStream& inbound_ring() { return *notnull( "inbound_ring", _inbound_ring.get() ); }
+  //!@}
+
 protected:
   //! Adapter to underlying datagram socket (e.g., UDP or IP)
   AdaptT _datagram_adapter;
@@ -66,6 +94,20 @@ private:
   //! Stream socket for reads and writes between owner and TCP thread
   LocalStreamSocket _thread_data;
 
+  //! How bytes are handed between the owner and the TCP thread
+  ThreadHandoff _handoff;
+
+  //! Shared rings between owner and TCP thread (ThreadHandoff::SharedRing only)
+  std::unique_ptr<SPSCByteStream> _outbound_ring {};
+  std::unique_ptr<SPSCByteStream> _inbound_ring {};
+
+  //! Move bytes between the shared rings and the TCPPeer (ThreadHandoff::SharedRing only)
+  void _pump_outbound_ring();
+  void _pump_inbound_ring();
+
+  //! Apply the owner's cork() or uncork() to the TCPPeer, and send what it allows
+  void _push();
+
   //! Set up the TCPPeer and the event loop
   void _initialize_TCP( const TCPConfig& config );
 
@@ -85,10 +127,14 @@ private:
   std::thread _tcp_thread {};
 
   //! Construct LocalStreamSocket fds from socket pair, initialize eventloop
-  TCPMinnowSocket( std::pair<FileDescriptor, FileDescriptor> data_socket_pair, AdaptT&& datagram_interface );
+  TCPMinnowSocket( std::pair<FileDescriptor, FileDescriptor> data_socket_pair,
+                   AdaptT&& datagram_interface,
+                   ThreadHandoff handoff );
 
   std::atomic_bool _abort { false }; //!< Flag used by the owner to force the TCPPeer thread to shut down
 
+  std::atomic_bool _corked { false }; //!< Has the owner corked the outbound data?
+
   bool _inbound_shutdown { false }; //!< Has TCPMinnowSocket shut down the incoming data to the owner?
 
   bool _outbound_shutdown { false }; //!< Has the owner shut down the outbound data to the TCP connection?
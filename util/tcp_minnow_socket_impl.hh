@@ -4,6 +4,7 @@
 #include "parser.hh"
 #include "tun.hh"
 
+#include <algorithm>
 #include <cstddef>
 #include <exception>
 #include <iostream>
@@ -30,11 +31,21 @@ void TCPMinnowSocket<AdaptT>::_tcp_loop( const std::function<bool()>& condition
 {
   auto base_time = timestamp_ms();
   while ( condition() ) {
-    auto ret = _eventloop.wait_next_event( TCP_TICK_MS );
+    // wake up early for the next paced segment
+    const auto release_ms = _tcp.has_value() ? _tcp->next_transmit_ms() : std::nullopt;
+    const auto wait_ms = std::min( TCP_TICK_MS, release_ms.value_or( TCP_TICK_MS ) );
+    auto ret = _eventloop.wait_next_event( static_cast<int>( wait_ms ) );
     if ( ret == EventLoop::Result::Exit or _abort ) { break; }
 
     if ( not _tcp.has_value() ) { throw std::runtime_error( "_tcp_loop entered before TCPPeer initialized" ); }
 
+    if ( _handoff == ThreadHandoff::SharedRing ) {
+      _pump_outbound_ring();
+      _pump_inbound_ring();
+    }
+
+    if ( _tcp->sender().corked() and not _corked.load() ) { _push(); } // uncorked with nothing new to send
+
     if ( _tcp.value().active() ) {
       const auto next_time = timestamp_ms();
       _tcp.value().tick( next_time - base_time, [&]( auto x ) { _datagram_adapter.write( x ); } );
@@ -44,14 +55,82 @@ void TCPMinnowSocket<AdaptT>::_tcp_loop( const std::function<bool()>& condition
   }
 }
 
+//! Moves the owner's bytes from the outbound ring into the TCPPeer (ThreadHandoff::SharedRing only)
+template<TCPDatagramAdapter AdaptT>
+void TCPMinnowSocket<AdaptT>::_pump_outbound_ring()
+{
+  Writer& outbound = _tcp->outbound_writer();
+  const uint64_t pushed_before = outbound.bytes_pushed();
+  while ( _outbound_ring->bytes_buffered() and outbound.available_capacity() ) {
+    const std::string_view buffer = _outbound_ring->peek().substr( 0, outbound.available_capacity() );
+    outbound.push( std::string { buffer } );
+    _outbound_ring->pop( buffer.size() );
+  }
+
+  if ( _outbound_ring->has_error() and not outbound.has_error() ) {
+    std::cerr << "DEBUG: minnow outbound stream had error.\n";
+    outbound.set_error();
+  }
+
+  if ( _outbound_ring->is_finished() and not _outbound_shutdown ) {
+    outbound.close();
+    _outbound_shutdown = true;
+
+    // debugging output:
+    std::cerr << "DEBUG: minnow outbound stream to " << _datagram_adapter.config().destination.to_string()
+              << " finished (" << _tcp.value().sender().sequence_numbers_in_flight() << " seqno"
+              << ( _tcp.value().sender().sequence_numbers_in_flight() == 1 ? "" : "s" ) << " still in flight).\n";
+  } else if ( outbound.bytes_pushed() == pushed_before ) {
+    return; // nothing new for the sender
+  }
+
+  _push();
+}
+
+template<TCPDatagramAdapter AdaptT>
+void TCPMinnowSocket<AdaptT>::_push()
+{
+  const auto write = [&]( auto x ) { _datagram_adapter.write( x ); };
+  if ( _corked.load() ) {
+    _tcp->cork();
+    _tcp->push( write );
+  } else {
+    _tcp->uncork( write );
+  }
+}
+
+//! Moves reassembled bytes from the TCPPeer into the inbound ring (ThreadHandoff::SharedRing only)
+template<TCPDatagramAdapter AdaptT>
+void TCPMinnowSocket<AdaptT>::_pump_inbound_ring()
+{
+  Reader& inbound = _tcp->inbound_reader();
+  while ( inbound.bytes_buffered() ) {
+    const uint64_t bytes_pushed = _inbound_ring->push( inbound.peek() );
+    if ( bytes_pushed == 0 ) { break; } // ring is full (or the owner gave up on it)
+    inbound.pop( bytes_pushed );
+  }
+
+  if ( ( inbound.is_finished() or inbound.has_error() ) and not _inbound_shutdown ) {
+    inbound.has_error() ? _inbound_ring->set_error() : _inbound_ring->close();
+    _inbound_shutdown = true;
+
+    // debugging output:
+    std::cerr << "DEBUG: minnow inbound stream from " << _datagram_adapter.config().destination.to_string()
+              << " finished " << ( inbound.has_error() ? "uncleanly.\n" : "cleanly.\n" );
+  }
+}
+
 //! \param[in] data_socket_pair is a pair of connected AF_UNIX SOCK_STREAM sockets
 //! \param[in] datagram_interface is the interface for reading and writing datagrams
+//! \param[in] handoff selects how bytes are passed between the owner and the TCPPeer thread
 template<TCPDatagramAdapter AdaptT>
 TCPMinnowSocket<AdaptT>::TCPMinnowSocket( std::pair<FileDescriptor, FileDescriptor> data_socket_pair,
-                                          AdaptT&& datagram_interface )
+                                          AdaptT&& datagram_interface,
+                                          ThreadHandoff handoff )
   : LocalStreamSocket( std::move( data_socket_pair.first ) )
   , _datagram_adapter( std::move( datagram_interface ) )
   , _thread_data( std::move( data_socket_pair.second ) )
+  , _handoff( handoff )
 {
   _thread_data.set_blocking( false );
   set_blocking( false );
@@ -87,7 +166,7 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
       }
 
       // debugging output:
-      if ( _thread_data.eof() and _tcp.value().sender().sequence_numbers_in_flight() == 0 and not _fully_acked ) {
+      if ( _outbound_shutdown and _tcp.value().sender().sequence_numbers_in_flight() == 0 and not _fully_acked ) {
         std::cerr << "DEBUG: minnow outbound stream to " << _datagram_adapter.config().destination.to_string()
                   << " has been fully acknowledged.\n";
         _fully_acked = true;
@@ -95,16 +174,35 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
     },
     [&] { return _tcp->active(); } );
 
+  if ( _handoff == ThreadHandoff::SharedRing ) {
+    _outbound_ring = std::make_unique<SPSCByteStream>( config.send_capacity );
+    _inbound_ring = std::make_unique<SPSCByteStream>( config.recv_capacity );
+
+    // rules 2 and 3 for the shared rings: the owner rings a doorbell after pushing into an empty outbound
+    // ring or popping from a full inbound ring; _tcp_loop pumps both rings after every event.
+    _eventloop.add_rule(
+      "owner pushed bytes into the outbound ring",
+      _outbound_ring->readable_event(),
+      Direction::In,
+      [&] { _outbound_ring->readable_event().clear(); },
+      [&] { return _tcp->active() and not _outbound_shutdown; } );
+
+    _eventloop.add_rule(
+      "owner popped bytes from the inbound ring",
+      _inbound_ring->writable_event(),
+      Direction::In,
+      [&] { _inbound_ring->writable_event().clear(); },
+      [&] { return _tcp->active() and not _inbound_shutdown; } );
+    return;
+  }
+
   // rule 2: read from pipe into outbound buffer
   _eventloop.add_rule(
     "push bytes to TCPPeer",
     _thread_data,
     Direction::In,
     [&] {
-      std::string data;
-      data.resize( _tcp->outbound_writer().available_capacity() );
-      _thread_data.read( data );
-      _tcp->outbound_writer().push( move( data ) );
+      _tcp->outbound_writer().push_from( _thread_data );
 
       if ( _thread_data.eof() ) {
         _tcp->outbound_writer().close();
@@ -117,7 +215,7 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
                   << " still in flight).\n";
       }
 
-      _tcp->push( [&]( auto x ) { _datagram_adapter.write( x ); } );
+      _push();
     },
     [&] {
       return ( _tcp->active() ) and ( not _outbound_shutdown )
@@ -143,8 +241,7 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
       // the pipe, handling the possibility of a partial
       // write (i.e., only pop what was actually written).
       if ( inbound.bytes_buffered() ) {
-        const std::string_view buffer = inbound.peek();
-        const auto bytes_written = _thread_data.write( buffer );
+        const auto bytes_written = _thread_data.write( inbound.peek_all() );
         inbound.pop( bytes_written );
       }
 
@@ -181,10 +278,12 @@ inline std::pair<SocketType, SocketType> socket_pair_helper( int domain, int typ
 }
 
 //! \param[in] datagram_interface is the underlying interface (e.g. to UDP, IP, or Ethernet)
+//! \param[in] handoff selects how bytes are passed between the owner and the TCPPeer thread
 template<TCPDatagramAdapter AdaptT>
-TCPMinnowSocket<AdaptT>::TCPMinnowSocket( AdaptT&& datagram_interface )
+TCPMinnowSocket<AdaptT>::TCPMinnowSocket( AdaptT&& datagram_interface, ThreadHandoff handoff )
   : TCPMinnowSocket( socket_pair_helper<LocalStreamSocket>( AF_UNIX, SOCK_STREAM ),
-                     std::move( datagram_interface ) )
+                     std::move( datagram_interface ),
+                     handoff )
 {}
 
 template<TCPDatagramAdapter AdaptT>
@@ -206,6 +305,7 @@ template<TCPDatagramAdapter AdaptT>
 void TCPMinnowSocket<AdaptT>::wait_until_closed()
 {
   shutdown( SHUT_RDWR );
+  if ( _outbound_ring ) { _outbound_ring->close(); }
   if ( _tcp_thread.joinable() ) {
     std::cerr << "DEBUG: minnow waiting for clean shutdown... ";
     _tcp_thread.join();
@@ -271,9 +371,14 @@ void TCPMinnowSocket<AdaptT>::_tcp_main()
     if ( not _tcp.has_value() ) { throw std::runtime_error( "no TCP" ); }
     _tcp_loop( [] { return true; } );
     shutdown( SHUT_RDWR );
+    if ( _inbound_ring and not _inbound_shutdown ) { _inbound_ring->set_error(); }
     if ( not _tcp.value().active() ) {
       std::cerr << "DEBUG: minnow TCP connection finished "
                 << ( _tcp->inbound_reader().has_error() ? "uncleanly.\n" : "cleanly.\n" );
+      const auto& reassembly = _tcp->receiver().reassembler().stats();
+      std::cerr << "DEBUG: minnow reassembler took the in-order path for " << reassembly.in_order << " of "
+                << reassembly.in_order + reassembly.out_of_order + reassembly.discarded << " segments ("
+                << reassembly.out_of_order << " stored, " << reassembly.discarded << " discarded).\n";
     }
     _tcp.reset();
   } catch ( const std::exception& e ) {
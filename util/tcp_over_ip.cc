@@ -6,6 +6,7 @@
 
 #include <arpa/inet.h>
 #include <stdexcept>
+#include <string>
 #include <unistd.h>
 #include <utility>
 
@@ -23,27 +24,29 @@ using namespace std;
 //! `_listen` flag and records the source and destination addresses and port numbers
 //! from the TCP header; it uses this information to filter future reads.
 //! \returns a std::optional<TCPSegment> that is empty if the segment was invalid or unrelated
-optional<TCPMessage> TCPOverIPv4Adapter::unwrap_tcp_in_ip( const InternetDatagram& ip_dgram )
+template<class ParserT>
+optional<TCPMessage> TCPOverIPv4Adapter::unwrap_tcp_in_ip( const IPv4Header& header, ParserT& payload )
 {
   // is the IPv4 datagram for us?
   // Note: it's valid to bind to address "0" (INADDR_ANY) and reply from actual address contacted
-  if ( not listening() and ( ip_dgram.header.dst != config().source.ipv4_numeric() ) ) {
+  if ( not listening() and ( header.dst != config().source.ipv4_numeric() ) ) {
     return {};
   }
 
   // is the IPv4 datagram from our peer?
-  if ( not listening() and ( ip_dgram.header.src != config().destination.ipv4_numeric() ) ) {
+  if ( not listening() and ( header.src != config().destination.ipv4_numeric() ) ) {
     return {};
   }
 
   // does the IPv4 datagram claim that its payload is a TCP segment?
-  if ( ip_dgram.header.proto != IPv4Header::PROTO_TCP ) {
+  if ( header.proto != IPv4Header::PROTO_TCP ) {
     return {};
   }
 
   // is the payload a valid TCP segment?
   TCPSegment tcp_seg;
-  if ( not parse( tcp_seg, ip_dgram.payload, ip_dgram.header.pseudo_checksum() ) ) {
+  tcp_seg.parse( payload, header.pseudo_checksum() );
+  if ( payload.has_error() ) {
     return {};
   }
 
@@ -55,9 +58,9 @@ optional<TCPMessage> TCPOverIPv4Adapter::unwrap_tcp_in_ip( const InternetDatagra
   // should we target this source addr/port (and use its destination addr as our source) in reply?
   if ( listening() ) {
     if ( tcp_seg.message.sender.SYN and not tcp_seg.message.sender.RST ) {
-      config_mutable().source = Address { inet_ntoa( { htobe32( ip_dgram.header.dst ) } ), config().source.port() };
+      config_mutable().source = Address { inet_ntoa( { htobe32( header.dst ) } ), config().source.port() };
       config_mutable().destination
-        = Address { inet_ntoa( { htobe32( ip_dgram.header.src ) } ), tcp_seg.udinfo.src_port };
+        = Address { inet_ntoa( { htobe32( header.src ) } ), tcp_seg.udinfo.src_port };
       set_listening( false );
     } else {
       return {};
@@ -72,6 +75,15 @@ optional<TCPMessage> TCPOverIPv4Adapter::unwrap_tcp_in_ip( const InternetDatagra
   return tcp_seg.message;
 }
 
+template optional<TCPMessage> TCPOverIPv4Adapter::unwrap_tcp_in_ip( const IPv4Header& header, Parser& payload );
+template optional<TCPMessage> TCPOverIPv4Adapter::unwrap_tcp_in_ip( const IPv4Header& header, SpanParser& payload );
+
+optional<TCPMessage> TCPOverIPv4Adapter::unwrap_tcp_in_ip( const InternetDatagram& ip_dgram )
+{
+  Parser payload { ip_dgram.payload };
+  return unwrap_tcp_in_ip( ip_dgram.header, payload );
+}
+
 //! Takes a TCP segment, sets port numbers as necessary, and wraps it in an IPv4 datagram
 //! \param[in] seg is the TCP segment to convert
 InternetDatagram TCPOverIPv4Adapter::wrap_tcp_in_ip( const TCPMessage& msg )
@@ -85,12 +97,32 @@ InternetDatagram TCPOverIPv4Adapter::wrap_tcp_in_ip( const TCPMessage& msg )
   InternetDatagram ip_dgram;
   ip_dgram.header.src = config().source.ipv4_numeric();
   ip_dgram.header.dst = config().destination.ipv4_numeric();
-  ip_dgram.header.len = ip_dgram.header.hlen * 4 + 20 /* tcp header len */ + seg.message.sender.payload.size();
+  ip_dgram.header.len = ip_dgram.header.hlen * 4 + seg.header_length() + seg.message.sender.payload.size();
 
-  // set payload, calculating TCP checksum using information from IP header
-  seg.compute_checksum( ip_dgram.header.pseudo_checksum() );
+  // set payload, writing the TCP header and checksum (using information from IP header) in one pass
+  string header( TCPSegment::MAX_HEADER_LENGTH, 0 );
+  header.resize( seg.serialize_header( header, ip_dgram.header.pseudo_checksum() ) );
   ip_dgram.header.compute_checksum();
-  ip_dgram.payload = serialize( seg );
+  ip_dgram.payload.push_back( move( header ) );
+  if ( not seg.message.sender.payload.empty() ) {
+    ip_dgram.payload.emplace_back( seg.message.sender.payload.view() );
+  }
 
   return ip_dgram;
 }
+
+void TCPOverIPv4Adapter::serialize_tcp_in_ip( const TCPMessage& msg, FixedSerializer& out )
+{
+  TCPSegment seg { .message = msg }; // (shares the payload with msg)
+  seg.udinfo.src_port = config().source.port();
+  seg.udinfo.dst_port = config().destination.port();
+
+  IPv4Header header;
+  header.src = config().source.ipv4_numeric();
+  header.dst = config().destination.ipv4_numeric();
+  header.len = header.hlen * 4 + seg.header_length() + seg.message.sender.payload.size();
+  header.compute_checksum();
+
+  header.serialize( out );
+  seg.serialize( out, header.pseudo_checksum() );
+}
@@ -12,5 +12,16 @@ class TCPOverIPv4Adapter : public FdAdapterBase
 public:
   std::optional<TCPMessage> unwrap_tcp_in_ip( const InternetDatagram& ip_dgram );
 
+  //! Likewise, given the datagram's header and a Parser or SpanParser positioned at its payload
+  template<class ParserT>
+  std::optional<TCPMessage> unwrap_tcp_in_ip( const IPv4Header& header, ParserT& payload );
+
   InternetDatagram wrap_tcp_in_ip( const TCPMessage& msg );
+
+  //! Likewise, but writes the IPv4 and TCP headers into `out` and adds the payload without copying it,
+  //! so that `out.output()` can be written straight to the device
+  void serialize_tcp_in_ip( const TCPMessage& msg, FixedSerializer& out );
+
+  //! Room for the headers that serialize_tcp_in_ip() writes
+  static constexpr size_t MAX_HEADERS_LENGTH = IPv4Header::LENGTH + TCPSegment::MAX_HEADER_LENGTH;
 };
@@ -7,6 +7,8 @@
 #include "tcp_sender.hh"
 #include "tcp_sender_message.hh"
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <optional>
 
@@ -28,13 +30,21 @@ public:
 
   /* Passthrough methods */
   void push( const TransmitFunction& transmit ) { sender_.push( make_send( transmit ) ); }
+  void cork() { sender_.cork(); }
+  void uncork( const TransmitFunction& transmit ) { sender_.uncork( make_send( transmit ) ); }
   void tick( uint64_t t, const TransmitFunction& transmit )
   {
     cumulative_time_ += t;
     sender_.tick( t, make_send( transmit ) );
+    if ( ack_deadline_ and cumulative_time_ >= *ack_deadline_ ) {
+      send( sender_.make_empty_message(), transmit ); // the delayed ACK
+    }
   }
   bool has_ackno() const { return receiver_.send().ackno.has_value(); }
 
+  /* With pacing, how long (ms) until the sender may release its next segment; tick() no later than that */
+  std::optional<uint64_t> next_transmit_ms() const { return sender_.next_transmit_ms(); }
+
   /* Is the peer still active? */
   bool active() const
   {
@@ -56,8 +66,11 @@ public:
     // Record time in case this peer has to linger after streams finish.
     time_of_last_receipt_ = cumulative_time_;
 
-    // If SenderMessage occupies a sequence number, make sure to reply.
-    need_send_ |= ( msg.sender.sequence_length() > 0 );
+    segments_received_ += 1;
+    const bool occupies_seqnos = msg.sender.sequence_length() > 0;
+    const bool control = msg.sender.SYN or msg.sender.FIN;
+    const size_t payload_size = msg.sender.payload.size();
+    const uint64_t pushed_before = receiver_.writer().bytes_pushed();
 
     // If SenderMessage is a "keep-alive" (with intentionally invalid seqno), make sure to reply.
     // (N.B. orthodox TCP rules require a reply on any unacceptable segment.)
@@ -69,9 +82,51 @@ public:
       linger_after_streams_finish_ = false;
     }
 
+    // Both sides must offer SACK (on their SYNs) before SACK blocks go on the wire.
+    if ( msg.sender.SYN ) {
+      peer_sack_permitted_ = msg.sender.sack_permitted;
+    }
+
+    // Likewise window scaling. The window on a SYN itself is never scaled.
+    if ( msg.sender.SYN and cfg_.window_scaling and msg.sender.window_scale ) {
+      window_scaling_ = true;
+      peer_window_shift_ = *msg.sender.window_scale;
+      receiver_.set_window_shift( window_shift() );
+    }
+    if ( window_scaling_ and not msg.sender.SYN ) {
+      msg.receiver.window_size <<= peer_window_shift_;
+    }
+
+    // And timestamps: without them, TSval and TSecr are ignored.
+    if ( msg.sender.SYN ) {
+      timestamps_ = cfg_.timestamps and msg.sender.TSval.has_value();
+      sender_.set_timestamps( timestamps_ );
+    }
+    if ( not timestamps_ ) {
+      msg.sender.TSval.reset();
+      msg.receiver.TSecr.reset();
+    }
+
+    // Send no larger segments than the peer's SYN said it accepts (or our own MSS, if it didn't say).
+    if ( msg.sender.SYN and msg.sender.mss ) {
+      sender_.set_peer_mss( msg.sender.mss );
+    }
+
     // Give incoming TCPSenderMessage to receiver.
     receiver_.receive( std::move( msg.sender ) );
 
+    // If SenderMessage occupies a sequence number, make sure to reply: at once, unless ACKs are delayed and
+    // this was the next in-order data (RFC 1122 section 4.2.3.2, RFC 5681 section 4.2).
+    if ( occupies_seqnos ) {
+      const bool in_order = receiver_.writer().bytes_pushed() - pushed_before == payload_size
+                            and receiver_.reassembler().bytes_pending() == 0;
+      if ( cfg_.ack_delay_ms == 0 or control or not in_order ) {
+        need_send_ = true;
+      } else {
+        delay_ack( payload_size );
+      }
+    }
+
     // Give incoming TCPReceiverMessage to sender.
     sender_.receive( msg.receiver );
 
@@ -85,19 +140,75 @@ public:
   // Testing interface
   const TCPReceiver& receiver() const { return receiver_; }
   const TCPSender& sender() const { return sender_; }
+  uint64_t segments_received() const { return segments_received_; }
+  uint64_t pure_acks_sent() const { return pure_acks_sent_; } // segments sent only to acknowledge
 
 private:
   TCPConfig cfg_;
-  TCPSender sender_ { ByteStream { cfg_.send_capacity }, cfg_.isn, cfg_.rt_timeout };
+  TCPSender sender_ { ByteStream { cfg_.send_capacity }, cfg_ };
   TCPReceiver receiver_ { Reassembler { ByteStream { cfg_.recv_capacity } } };
 
   bool need_send_ {};
+  bool peer_sack_permitted_ {};
+  bool window_scaling_ {};
+  bool timestamps_ {};
+
+  uint64_t unacked_bytes_ {};               // in-order bytes received since the last ACK went out
+  std::optional<uint64_t> ack_deadline_ {}; // when the delayed ACK is due (in cumulative_time_)
+  uint64_t segments_received_ {};
+  uint64_t pure_acks_sent_ {};
+
+  // ACK every second full-sized segment, or when the delayed-ACK timer runs out
+  void delay_ack( size_t payload_size )
+  {
+    unacked_bytes_ += payload_size;
+    if ( unacked_bytes_ >= 2UL * cfg_.mss ) {
+      need_send_ = true;
+    } else if ( not ack_deadline_ ) {
+      ack_deadline_ = cumulative_time_ + cfg_.ack_delay_ms;
+    }
+  }
+  uint8_t peer_window_shift_ {};
+
+  // The smallest shift that lets the advertised window cover the whole receive capacity
+  uint8_t window_shift() const
+  {
+    uint8_t shift = 0;
+    while ( shift < TCPReceiverMessage::MAX_WINDOW_SHIFT and ( cfg_.recv_capacity >> shift ) > UINT16_MAX ) {
+      ++shift;
+    }
+    return shift;
+  }
 
   void send( const TCPSenderMessage& sender_message, const TransmitFunction& transmit )
   {
     TCPMessage msg { sender_message, receiver_.send() };
+    msg.sender.sack_permitted = msg.sender.SYN and cfg_.sack;
+    msg.sender.mss = msg.sender.SYN ? cfg_.mss : uint16_t {};
+    if ( msg.sender.SYN ) {
+      // Offer window scaling on a SYN, and accept it on a SYN-ACK only if the peer offered it.
+      if ( msg.receiver.ackno ? window_scaling_ : cfg_.window_scaling ) {
+        msg.sender.window_scale = window_shift();
+      }
+      msg.receiver.window_size = std::min( msg.receiver.window_size, uint32_t { UINT16_MAX } );
+      msg.receiver.window_shift = 0;
+    }
+    const bool offer_timestamps = msg.sender.SYN and not msg.receiver.ackno and cfg_.timestamps;
+    if ( not( timestamps_ or offer_timestamps ) ) {
+      msg.sender.TSval.reset();
+      msg.receiver.TSecr.reset();
+    }
+    if ( msg.sender.payload.size() > sender_.mss() ) {
+      msg.segment_size = sender_.mss(); // a super-segment, for the adapter to split
+    }
+    if ( not( cfg_.sack and peer_sack_permitted_ ) ) {
+      msg.receiver.sack.clear();
+    }
+    pure_acks_sent_ += msg.sender.sequence_length() == 0;
     transmit( std::move( msg ) );
     need_send_ = false;
+    unacked_bytes_ = 0; // every segment carries the ACK
+    ack_deadline_.reset();
   }
 
   bool linger_after_streams_finish_ { true }; // one peer may need to linger to make sure all closure conditions met
@@ -2,26 +2,47 @@
 
 #include "wrapping_integers.hh"
 
+#include <cstddef>
 #include <optional>
+#include <vector>
 
 /*
  * The TCPReceiverMessage structure contains the information sent from a TCP receiver to its sender.
  *
- * It contains three fields:
+ * It contains five fields:
  *
  * 1) The acknowledgment number (ackno): the *next* sequence number needed by the TCP Receiver.
  *    This is an optional field that is empty if the TCPReceiver hasn't yet received the Initial Sequence Number.
  *
  * 2) The window size. This is the number of sequence numbers that the TCP receiver is interested
- *    to receive, starting from the ackno if present. The maximum value is 65,535 (UINT16_MAX from
- *    the <cstdint> header).
+ *    to receive, starting from the ackno if present. The header's field is 16 bits, so unless the
+ *    peers negotiated window scaling (RFC 7323), the maximum value is 65,535 (UINT16_MAX from the
+ *    <cstdint> header). With it, the field carries window_size >> window_shift.
  *
  * 3) The RST (reset) flag. If set, the stream has suffered an error and the connection should be aborted.
+ *
+ * 4) The SACK blocks (RFC 2018): up to MAX_SACK_BLOCKS ranges of sequence numbers, beyond the ackno,
+ *    that the receiver already holds, so the sender need not retransmit them.
+ *
+ * 5) With timestamps (RFC 7323), TSecr: the TSval of the peer's most recent in-order segment, echoed
+ *    back so that the peer's sender can measure the round-trip time of any segment, even a retransmission.
  */
 
+struct SACKBlock
+{
+  Wrap32 left { 0 };  // first sequence number of the block
+  Wrap32 right { 0 }; // sequence number just past the block
+};
+
 struct TCPReceiverMessage
 {
+  static constexpr size_t MAX_SACK_BLOCKS = 4; // as many as fit in the TCP header's 40 bytes of options
+  static constexpr uint8_t MAX_WINDOW_SHIFT = 14; // RFC 7323 section 2.3
+
   std::optional<Wrap32> ackno {};
-  uint16_t window_size {};
+  uint32_t window_size {};
+  uint8_t window_shift {}; // the window scale this receiver advertised (0 on a SYN, or without scaling)
   bool RST {};
+  std::vector<SACKBlock> sack {};
+  std::optional<uint32_t> TSecr {};
 };
@@ -2,13 +2,215 @@
 #include "checksum.hh"
 #include "wrapping_integers.hh"
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string_view>
 
 static constexpr uint32_t TCPHeaderMinLen = 5; // 32-bit words
 
 using namespace std;
 
-void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum )
+namespace {
+// TCP option kinds
+constexpr uint8_t OptEnd = 0;
+constexpr uint8_t OptNOP = 1;
+constexpr uint8_t OptMSS = 2;
+constexpr uint8_t OptWindowScale = 3;
+constexpr uint8_t OptSACKPermitted = 4;
+constexpr uint8_t OptSACK = 5;
+constexpr uint8_t OptTimestamps = 8;
+
+constexpr size_t MaxOptionsLen = 40; // bytes
+
+class Wrap32Serializable : public Wrap32
+{
+public:
+  uint32_t raw_value() const { return raw_value_; }
+};
+
+// Bytes of the options (a multiple of 4) other than SACK
+size_t fixed_options_length( const TCPMessage& message )
+{
+  size_t len = 0;
+  if ( message.sender.SYN and message.sender.mss ) {
+    len += 4; // MSS (4 bytes)
+  }
+  if ( message.sender.SYN and message.sender.window_scale ) {
+    len += 4; // NOP, window scale (3 bytes)
+  }
+  if ( message.sender.SYN and message.sender.sack_permitted ) {
+    len += 4; // NOP, NOP, SACK-permitted (2 bytes)
+  }
+  if ( message.sender.TSval ) {
+    len += 12; // NOP, NOP, timestamps (10 bytes)
+  }
+  return len;
+}
+
+// SACK blocks that fit in what's left of the option space (three, alongside timestamps)
+size_t sack_blocks( const TCPMessage& message )
+{
+  if ( message.receiver.sack.empty() ) {
+    return 0;
+  }
+  const size_t room = ( MaxOptionsLen - fixed_options_length( message ) - 4 ) / 8; // after NOP, NOP, kind, length
+  return min( { message.receiver.sack.size(), TCPReceiverMessage::MAX_SACK_BLOCKS, room } );
+}
+
+// Bytes of options (a multiple of 4) that serialize_options() will write for this message
+size_t options_length( const TCPMessage& message )
+{
+  const size_t blocks = sack_blocks( message );
+  return fixed_options_length( message ) + ( blocks ? 4 + 8 * blocks : 0 ); // NOP, NOP, SACK
+}
+
+template<class S>
+void serialize_options( const TCPMessage& message, S& serializer )
+{
+  if ( message.sender.SYN and message.sender.mss ) {
+    serializer.integer( OptMSS );
+    serializer.integer( uint8_t { 4 } );
+    serializer.integer( message.sender.mss );
+  }
+  if ( message.sender.SYN and message.sender.window_scale ) {
+    serializer.integer( OptNOP );
+    serializer.integer( OptWindowScale );
+    serializer.integer( uint8_t { 3 } );
+    serializer.integer( *message.sender.window_scale );
+  }
+  if ( message.sender.SYN and message.sender.sack_permitted ) {
+    serializer.integer( OptNOP );
+    serializer.integer( OptNOP );
+    serializer.integer( OptSACKPermitted );
+    serializer.integer( uint8_t { 2 } );
+  }
+  if ( message.sender.TSval ) {
+    serializer.integer( OptNOP );
+    serializer.integer( OptNOP );
+    serializer.integer( OptTimestamps );
+    serializer.integer( uint8_t { 10 } );
+    serializer.integer( *message.sender.TSval );
+    serializer.integer( message.receiver.TSecr.value_or( 0 ) );
+  }
+  if ( const size_t blocks = sack_blocks( message ); blocks > 0 ) {
+    serializer.integer( OptNOP );
+    serializer.integer( OptNOP );
+    serializer.integer( OptSACK );
+    serializer.integer( static_cast<uint8_t>( 2 + 8 * blocks ) );
+    for ( const auto& [left, right] : span { message.receiver.sack }.first( blocks ) ) {
+      serializer.integer( Wrap32Serializable { left }.raw_value() );
+      serializer.integer( Wrap32Serializable { right }.raw_value() );
+    }
+  }
+}
+
+// Parse `len` bytes of options, skipping the kinds we don't know
+template<class ParserT>
+void parse_options( ParserT& parser, size_t len, TCPMessage& message )
+{
+  while ( len > 0 and not parser.has_error() ) {
+    uint8_t kind {};
+    parser.integer( kind );
+    --len;
+    if ( kind == OptEnd ) {
+      break;
+    }
+    if ( kind == OptNOP ) {
+      continue;
+    }
+
+    uint8_t option_len {};
+    parser.integer( option_len );
+    if ( option_len < 2 or option_len - 1U > len ) {
+      parser.set_error();
+      return;
+    }
+    len -= option_len - 1U;
+    size_t body_len = option_len - 2U;
+
+    if ( kind == OptMSS and body_len == 2 ) {
+      parser.integer( message.sender.mss );
+      body_len = 0;
+    } else if ( kind == OptWindowScale and body_len == 1 ) {
+      uint8_t shift {};
+      parser.integer( shift );
+      message.sender.window_scale = min( shift, TCPReceiverMessage::MAX_WINDOW_SHIFT );
+      body_len = 0;
+    } else if ( kind == OptTimestamps and body_len == 8 ) {
+      uint32_t echo {};
+      message.sender.TSval.emplace();
+      parser.integer( *message.sender.TSval );
+      parser.integer( echo );
+      if ( message.receiver.ackno ) {
+        message.receiver.TSecr = echo; // only meaningful with the ACK flag
+      }
+      body_len = 0;
+    } else if ( kind == OptSACKPermitted ) {
+      message.sender.sack_permitted = true;
+    } else if ( kind == OptSACK and body_len % 8 == 0 ) {
+      for ( ; body_len > 0; body_len -= 8 ) {
+        uint32_t left {};
+        uint32_t right {};
+        parser.integer( left );
+        parser.integer( right );
+        message.receiver.sack.push_back( { Wrap32 { left }, Wrap32 { right } } );
+      }
+    }
+    parser.remove_prefix( body_len );
+  }
+  parser.remove_prefix( len ); // padding after an end-of-options
+}
+
+// The header, options included, to a Serializer or a FixedSerializer
+template<class S>
+void write_header( const TCPSegment& segment, const size_t header_length, S& serializer )
+{
+  const auto& [message, udinfo] = segment;
+  serializer.integer( udinfo.src_port );
+  serializer.integer( udinfo.dst_port );
+  serializer.integer( Wrap32Serializable { message.sender.seqno }.raw_value() );
+  serializer.integer( Wrap32Serializable { message.receiver.ackno.value_or( Wrap32 { 0 } ) }.raw_value() );
+  serializer.integer( static_cast<uint8_t>( header_length / 4 << 4 ) ); // data offset
+  const bool reset = message.sender.RST or message.receiver.RST;
+  const uint8_t flags = ( message.receiver.ackno.has_value() ? 0b0001'0000U : 0 ) | ( reset ? 0b0000'0100U : 0 )
+                        | ( message.sender.SYN ? 0b0000'0010U : 0 ) | ( message.sender.FIN ? 0b0000'0001U : 0 );
+  serializer.integer( flags );
+  const uint32_t window = message.receiver.window_size >> message.receiver.window_shift;
+  serializer.integer( static_cast<uint16_t>( min( window, uint32_t { UINT16_MAX } ) ) );
+  serializer.integer( udinfo.cksum );
+  serializer.integer( uint16_t { 0 } ); // urgent pointer
+  serialize_options( message, serializer );
+}
+} // namespace
+
+void split_segments( const TCPMessage& message, const function<void( const TCPMessage& )>& emit )
+{
+  const size_t size = message.segment_size;
+  const Buffer& payload = message.sender.payload;
+  if ( size == 0 or payload.size() <= size ) {
+    emit( message );
+    return;
+  }
+
+  TCPMessage segment = message;
+  segment.segment_size = 0;
+  for ( size_t offset = 0; offset < payload.size(); offset += size ) {
+    const bool first = offset == 0;
+    segment.sender.seqno = message.sender.seqno + static_cast<uint32_t>( first ? 0 : message.sender.SYN + offset );
+    segment.sender.SYN = first and message.sender.SYN;
+    segment.sender.payload = payload.substr( offset, size );
+    segment.sender.FIN = offset + size >= payload.size() and message.sender.FIN;
+    segment.sender.sack_permitted = first and message.sender.sack_permitted;
+    segment.sender.mss = first ? message.sender.mss : uint16_t {};
+    emit( segment );
+  }
+}
+
+template<class ParserT>
+void TCPSegment::parse( ParserT& parser, uint32_t datagram_layer_pseudo_checksum )
 {
   /* verify checksum */
   InternetChecksum check { datagram_layer_pseudo_checksum };
@@ -20,6 +222,7 @@ void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum
 
   uint32_t raw32 {};
   uint16_t raw16 {};
+  uint16_t window {};
   uint8_t octet {};
 
   parser.integer( udinfo.src_port );
@@ -43,49 +246,67 @@ void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum
   message.sender.SYN = octet & 0b0000'0010;
   message.sender.FIN = octet & 0b0000'0001;
 
-  parser.integer( message.receiver.window_size );
+  parser.integer( window );
+  message.receiver.window_size = window; // the peer scales it, if window scaling was negotiated
   parser.integer( udinfo.cksum );
   parser.integer( raw16 ); // urgent pointer
 
-  // skip any options or anything extra in the header
   if ( data_offset < TCPHeaderMinLen ) {
     parser.set_error();
+    return;
   }
-  parser.remove_prefix( data_offset * 4 - TCPHeaderMinLen * 4 );
+  parse_options( parser, data_offset * 4 - TCPHeaderMinLen * 4, message );
 
-  parser.all_remaining( message.sender.payload );
+  string payload;
+  parser.all_remaining( payload );
+  message.sender.payload = std::move( payload );
 }
 
-class Wrap32Serializable : public Wrap32
+template void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum );
+template void TCPSegment::parse( SpanParser& parser, uint32_t datagram_layer_pseudo_checksum );
+
+size_t TCPSegment::header_length() const
 {
-public:
-  uint32_t raw_value() const { return raw_value_; }
-};
+  return TCPHeaderMinLen * 4 + options_length( message );
+}
 
 void TCPSegment::serialize( Serializer& serializer ) const
 {
-  serializer.integer( udinfo.src_port );
-  serializer.integer( udinfo.dst_port );
-  serializer.integer( Wrap32Serializable { message.sender.seqno }.raw_value() );
-  serializer.integer( Wrap32Serializable { message.receiver.ackno.value_or( Wrap32 { 0 } ) }.raw_value() );
-  serializer.integer( uint8_t { TCPHeaderMinLen << 4 } ); // data offset
-  const bool reset = message.sender.RST or message.receiver.RST;
-  const uint8_t flags = ( message.receiver.ackno.has_value() ? 0b0001'0000U : 0 ) | ( reset ? 0b0000'0100U : 0 )
-                        | ( message.sender.SYN ? 0b0000'0010U : 0 ) | ( message.sender.FIN ? 0b0000'0001U : 0 );
-  serializer.integer( flags );
-  serializer.integer( message.receiver.window_size );
-  serializer.integer( udinfo.cksum );
-  serializer.integer( uint16_t { 0 } ); // urgent pointer
-  serializer.buffer( message.sender.payload );
+  write_header( *this, header_length(), serializer );
+  serializer.buffer( string { message.sender.payload.view() } );
 }
 
-void TCPSegment::compute_checksum( uint32_t datagram_layer_pseudo_checksum )
+void TCPSegment::serialize( FixedSerializer& serializer, uint32_t datagram_layer_pseudo_checksum )
 {
+  const size_t len = header_length();
+  if ( serializer.position() + len > serializer.capacity() ) {
+    throw runtime_error( "TCPSegment::serialize: buffer too small" );
+  }
+
+  const size_t start = serializer.position();
   udinfo.cksum = 0;
-  Serializer s;
-  serialize( s );
+  write_header( *this, len, serializer );
 
+  const span<char> header = serializer.written().subspan( start );
   InternetChecksum check { datagram_layer_pseudo_checksum };
-  check.add( s.output() );
+  check.add( string_view { header.data(), header.size() } );
+  check.add( message.sender.payload.view() );
   udinfo.cksum = check.value();
+  header[16] = static_cast<char>( udinfo.cksum >> 8 );
+  header[17] = static_cast<char>( udinfo.cksum );
+
+  serializer.buffer( message.sender.payload.view() );
+}
+
+size_t TCPSegment::serialize_header( span<char> header, uint32_t datagram_layer_pseudo_checksum )
+{
+  FixedSerializer serializer { header };
+  serialize( serializer, datagram_layer_pseudo_checksum );
+  return serializer.position();
+}
+
+void TCPSegment::compute_checksum( uint32_t datagram_layer_pseudo_checksum )
+{
+  array<char, MAX_HEADER_LENGTH> header {};
+  serialize_header( header, datagram_layer_pseudo_checksum );
 }
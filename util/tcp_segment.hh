@@ -5,19 +5,43 @@
 #include "tcp_sender_message.hh"
 #include "udinfo.hh"
 
+#include <cstddef>
+#include <functional>
+#include <span>
+
 struct TCPMessage
 {
   TCPSenderMessage sender {};
   TCPReceiverMessage receiver {};
+
+  // If nonzero, a super-segment: the adapter sends its payload in segments of at most this many bytes
+  size_t segment_size {};
 };
 
+// Call `emit` with each wire-sized segment of a message (just the message itself, unless it's a super-segment).
+// The segments share the message's payload rather than copying it.
+void split_segments( const TCPMessage& message, const std::function<void( const TCPMessage& )>& emit );
+
 struct TCPSegment
 {
   TCPMessage message {};
   UserDatagramInfo udinfo {};
 
-  void parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum );
+  static constexpr size_t MAX_HEADER_LENGTH = 60; // bytes, with 40 bytes of options
+
+  template<class ParserT> // Parser or SpanParser
+  void parse( ParserT& parser, uint32_t datagram_layer_pseudo_checksum );
   void serialize( Serializer& serializer ) const;
 
+  // Write the header into `serializer`, filling in the checksum, then add the payload without copying it
+  void serialize( FixedSerializer& serializer, uint32_t datagram_layer_pseudo_checksum );
+
+  // Length of the TCP header, including options, in bytes
+  [[nodiscard]] size_t header_length() const;
+
   void compute_checksum( uint32_t datagram_layer_pseudo_checksum );
+
+  // Write the header into `header` and fill in the checksum, summing the payload in place rather than copying it.
+  // On the wire, the segment is the header_length() bytes returned, then message.sender.payload.
+  size_t serialize_header( std::span<char> header, uint32_t datagram_layer_pseudo_checksum );
 };
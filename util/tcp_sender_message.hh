@@ -1,13 +1,14 @@
 #pragma once
 
+#include "buffer.hh"
 #include "wrapping_integers.hh"
 
-#include <string>
+#include <optional>
 
 /*
  * The TCPSenderMessage structure contains the information sent from a TCP sender to its receiver.
  *
- * It contains five fields:
+ * It contains nine fields:
  *
  * 1) The sequence number (seqno) of the beginning of the segment. If the SYN flag is set, this is the
  *    sequence number of the SYN flag. Otherwise, it's the sequence number of the beginning of the payload.
@@ -15,11 +16,20 @@
  * 2) The SYN flag. If set, this segment is the beginning of the byte stream, and the seqno field
  *    contains the Initial Sequence Number (ISN) -- the zero point.
  *
- * 3) The payload: a substring (possibly empty) of the byte stream.
+ * 3) The payload: a substring (possibly empty) of the byte stream. It is a refcounted Buffer, so copies of
+ *    the message (e.g. queued for retransmission) share the payload's bytes.
  *
  * 4) The FIN flag. If set, the payload represents the ending of the byte stream.
  *
  * 5) The RST (reset) flag. If set, the stream has suffered an error and the connection should be aborted.
+ *
+ * 6) On a SYN, whether this peer will accept SACK blocks from the other (the SACK-permitted option).
+ *
+ * 7) On a SYN, the largest payload this peer will accept in one segment (the MSS option), or 0 if unstated.
+ *
+ * 8) On a SYN, the shift this peer will apply to the windows it advertises (the window-scale option), if any.
+ *
+ * 9) With timestamps (RFC 7323), TSval: the sender's clock, in milliseconds, when it sent this segment.
  */
 
 struct TCPSenderMessage
@@ -27,11 +37,16 @@ struct TCPSenderMessage
   Wrap32 seqno { 0 };
 
   bool SYN {};
-  std::string payload {};
+  Buffer payload {};
   bool FIN {};
 
   bool RST {};
 
+  bool sack_permitted {};
+  uint16_t mss {};
+  std::optional<uint8_t> window_scale {};
+  std::optional<uint32_t> TSval {};
+
   // How many sequence numbers does this segment use?
   [[nodiscard]] size_t sequence_length() const { return SYN + payload.size() + FIN; }
   [[nodiscard]] bool empty() const { return sequence_length() == 0; }
@@ -1,20 +1,23 @@
 #include "tuntap_adapter.hh"
 #include "parser.hh"
 
+#include <span>
+
 using namespace std;
 
 optional<TCPMessage> TCPOverIPv4OverTunFdAdapter::read()
 {
-  vector<string> strs( 2 );
-  strs.front().resize( IPv4Header::LENGTH );
-  _tun.read( strs );
+  // parse the datagram where it was read (only the TCP payload gets copied out)
+  const span<char> buffer { _read_buffer };
+  const size_t len = _tun.read( span { &buffer, 1 } );
 
-  InternetDatagram ip_dgram;
-  const vector<string> buffers = { strs.at( 0 ), strs.at( 1 ) };
-  if ( parse( ip_dgram, buffers ) ) {
-    return unwrap_tcp_in_ip( ip_dgram );
+  SpanParser parser { buffer.first( len ) };
+  IPv4Header header;
+  header.parse( parser );
+  if ( parser.has_error() ) {
+    return {};
   }
-  return {};
+  return unwrap_tcp_in_ip( header, parser );
 }
 
 //! Specialize LossyFdAdapter to TCPOverIPv4OverTunFdAdapter
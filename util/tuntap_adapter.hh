@@ -4,7 +4,10 @@
 #include "tcp_segment.hh"
 #include "tun.hh"
 
+#include <array>
+#include <cstddef>
 #include <optional>
+#include <string>
 #include <unordered_map>
 #include <utility>
 
@@ -24,16 +27,27 @@ class TCPOverIPv4OverTunFdAdapter : public TCPOverIPv4Adapter
 {
 private:
   TunFD _tun;
+  std::string _read_buffer = std::string( MAX_DATAGRAM_SIZE, 0 ); //!< read() parses datagrams in place here
 
 public:
+  static constexpr size_t MAX_DATAGRAM_SIZE = 65535; //!< the largest IPv4 datagram
+
   //! Construct from a TunFD
   explicit TCPOverIPv4OverTunFdAdapter( TunFD&& tun ) : _tun( std::move( tun ) ) {}
 
   //! Attempts to read and parse an IPv4 datagram containing a TCP segment related to the current connection
   std::optional<TCPMessage> read();
 
-  //! Creates an IPv4 datagram from a TCP segment and writes it to the TUN device
-  void write( const TCPMessage& seg ) { _tun.write( serialize( wrap_tcp_in_ip( seg ) ) ); }
+  //! Creates an IPv4 datagram from a TCP segment (or each piece of a super-segment) and writes it to the TUN device
+  void write( const TCPMessage& seg )
+  {
+    split_segments( seg, [&]( const TCPMessage& piece ) {
+      std::array<char, MAX_HEADERS_LENGTH> headers {};
+      FixedSerializer serializer { headers };
+      serialize_tcp_in_ip( piece, serializer );
+      _tun.write( serializer.output() ); // headers and payload in one writev(), without copying the payload
+    } );
+  }
 
   //! Access the underlying TUN device
   explicit operator TunFD&() { return _tun; }